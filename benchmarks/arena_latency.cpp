@@ -0,0 +1,131 @@
+// Per-frame latency of scratch buffers allocated from std::vector vs. a FrameArena
+//
+// Simulates a control loop, that allocates a handful of UPos/USpeed scratch arrays of varying size
+// every tick, does a little work on them and throws them away again.
+
+#include <mba-units/arena.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace mba;
+
+namespace {
+
+constexpr int frames            = 20000;
+constexpr int buffers_per_frame = 16;
+
+struct FrameSizes {
+	std::size_t sizes[buffers_per_frame];
+};
+
+std::vector<FrameSizes> make_sizes()
+{
+	std::mt19937                               gen( 42 );
+	std::uniform_int_distribution<std::size_t> dist( 16, 4096 );
+
+	std::vector<FrameSizes> res( frames );
+	for( auto& f : res ) {
+		for( auto& s : f.sizes ) {
+			s = dist( gen );
+		}
+	}
+	return res;
+}
+
+template<class SpeedBuffer, class PosBuffer>
+double work( SpeedBuffer& v, PosBuffer& p, std::size_t n )
+{
+	const units::UTime dt{0.001};
+	for( std::size_t i = 0; i < n; ++i ) {
+		v[i] = units::USpeed{static_cast<double>( i )};
+		p[i] = v[i] * dt;
+	}
+	return p[n / 2].value;
+}
+
+void report( const char* name, std::vector<double>& ns )
+{
+	std::sort( ns.begin(), ns.end() );
+	auto pct = [&]( double p ) { return ns[static_cast<std::size_t>( p * ( ns.size() - 1 ) )]; };
+	std::printf( "%-12s p50 %8.0fns  p99 %8.0fns  p99.9 %8.0fns  max %8.0fns\n",
+				 name,
+				 pct( 0.5 ),
+				 pct( 0.99 ),
+				 pct( 0.999 ),
+				 ns.back() );
+}
+
+template<class Frame>
+std::vector<double> run( const std::vector<FrameSizes>& sizes, Frame&& frame, double& sink )
+{
+	std::vector<double> ns;
+	ns.reserve( sizes.size() );
+	for( const auto& f : sizes ) {
+		const auto start = std::chrono::steady_clock::now();
+		sink += frame( f );
+		const auto end = std::chrono::steady_clock::now();
+		ns.push_back( std::chrono::duration<double, std::nano>( end - start ).count() );
+	}
+	return ns;
+}
+
+} // namespace
+
+int main()
+{
+	const auto sizes = make_sizes();
+	double     sink  = 0;
+
+	auto vector_times = run(
+		sizes,
+		[]( const FrameSizes& f ) {
+			double res = 0;
+			for( auto n : f.sizes ) {
+				std::vector<units::USpeed> v( n );
+				std::vector<units::UPos>   p( n );
+				res += work( v, p, n );
+			}
+			return res;
+		},
+		sink );
+
+	units::FrameArena arena;
+	auto arena_times = run(
+		sizes,
+		[&]( const FrameSizes& f ) {
+			double res = 0;
+			for( auto n : f.sizes ) {
+				auto v = units::make_arena_array<units::USpeed>( arena, n );
+				auto p = units::make_arena_array<units::UPos>( arena, n );
+				res += work( v, p, n );
+			}
+			arena.reset();
+			return res;
+		},
+		sink );
+
+	units::ArenaResource resource( arena );
+	auto pmr_times = run(
+		sizes,
+		[&]( const FrameSizes& f ) {
+			double res = 0;
+			for( auto n : f.sizes ) {
+				std::pmr::vector<units::USpeed> v( n, &resource );
+				std::pmr::vector<units::UPos>   p( n, &resource );
+				res += work( v, p, n );
+			}
+			arena.reset();
+			return res;
+		},
+		sink );
+
+	report( "std::vector", vector_times );
+	report( "FrameArena", arena_times );
+	report( "pmr adapter", pmr_times );
+
+	return sink == 0.0 ? 1 : 0;
+}
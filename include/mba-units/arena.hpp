@@ -0,0 +1,223 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// When enabled, arena memory is overwritten with 0xFF bytes on creation and reset,
+// so stale Unit values read from a previous frame show up as NaN. Off in release builds by default.
+#ifndef MBA_UNITS_ARENA_POISON
+#ifdef NDEBUG
+#define MBA_UNITS_ARENA_POISON 0
+#else
+#define MBA_UNITS_ARENA_POISON 1
+#endif
+#endif
+
+namespace mba::units {
+
+/*
+ * Monotonic arena for per-frame scratch memory.
+ *
+ * Allocation is a pointer bump, deallocation a no-op. reset() releases everything at once
+ * (call it once per frame/tick). If a frame needed more than one block, the blocks are
+ * merged into a single one on reset, so after warm up, a frame does not touch the heap at all.
+ */
+class FrameArena {
+public:
+	// every allocation is aligned to at least this (cache line / widest SIMD register)
+	static constexpr std::size_t simd_alignment = 64;
+
+	static constexpr unsigned char poison_byte = 0xFF;
+
+	explicit FrameArena( std::size_t initial_capacity = 64 * 1024 ) { _add_block( initial_capacity ); }
+
+	FrameArena( const FrameArena& ) = delete;
+	FrameArena& operator=( const FrameArena& ) = delete;
+
+	~FrameArena()
+	{
+		for( auto& b : _blocks ) {
+			_free( b );
+		}
+	}
+
+	void* allocate( std::size_t bytes, std::size_t alignment = simd_alignment )
+	{
+		alignment = std::max( alignment, simd_alignment );
+
+		if( void* p = _bump( bytes, alignment ) ) {
+			return p;
+		}
+		_add_block( std::max( 2 * _blocks.back().size, bytes + alignment ) );
+		return _bump( bytes, alignment );
+	}
+
+	// Releases all allocations. Memory handed out before must not be used anymore.
+	void reset()
+	{
+		if( _blocks.size() > 1 ) {
+			const std::size_t total = capacity();
+			for( auto& b : _blocks ) {
+				_free( b );
+			}
+			_blocks.clear();
+			_add_block( total );
+		} else {
+#if MBA_UNITS_ARENA_POISON
+			std::memset( _blocks.back().data, poison_byte, _offset );
+#endif
+		}
+		_offset = 0;
+	}
+
+	// bytes available without allocating a new block, after reset
+	std::size_t capacity() const noexcept
+	{
+		std::size_t total = 0;
+		for( auto& b : _blocks ) {
+			total += b.size;
+		}
+		return total;
+	}
+
+	std::size_t block_count() const noexcept { return _blocks.size(); }
+
+private:
+	struct Block {
+		unsigned char* data;
+		std::size_t    size;
+	};
+
+	static constexpr std::uintptr_t _align_up( std::uintptr_t v, std::size_t alignment ) noexcept
+	{
+		return ( v + alignment - 1 ) & ~static_cast<std::uintptr_t>( alignment - 1 );
+	}
+
+	// returns nullptr if the request does not fit into the current block
+	void* _bump( std::size_t bytes, std::size_t alignment ) noexcept
+	{
+		const Block&         b       = _blocks.back();
+		const std::uintptr_t base    = reinterpret_cast<std::uintptr_t>( b.data );
+		const std::size_t    aligned = static_cast<std::size_t>( _align_up( base + _offset, alignment ) - base );
+		if( aligned + bytes > b.size ) {
+			return nullptr;
+		}
+		_offset = aligned + bytes;
+		return b.data + aligned;
+	}
+
+	void _add_block( std::size_t size )
+	{
+		size = static_cast<std::size_t>( _align_up( std::max<std::size_t>( size, simd_alignment ), simd_alignment ) );
+		_blocks.reserve( _blocks.size() + 1 );
+		auto* data = static_cast<unsigned char*>( ::operator new( size, std::align_val_t{simd_alignment} ) );
+#if MBA_UNITS_ARENA_POISON
+		std::memset( data, poison_byte, size );
+#endif
+		_blocks.push_back( Block{data, size} );
+		_offset = 0;
+	}
+
+	static void _free( Block& b ) noexcept { ::operator delete( b.data, std::align_val_t{simd_alignment} ); }
+
+	std::vector<Block> _blocks;
+	std::size_t        _offset = 0;
+};
+
+// Standard allocator interface on top of a FrameArena (e.g. for std::vector)
+template<class T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	ArenaAllocator( FrameArena& arena ) noexcept
+		: _arena{&arena}
+	{
+	}
+
+	template<class O>
+	ArenaAllocator( const ArenaAllocator<O>& other ) noexcept
+		: _arena{other.arena()}
+	{
+	}
+
+	T* allocate( std::size_t n ) { return static_cast<T*>( _arena->allocate( n * sizeof( T ), alignof( T ) ) ); }
+	void deallocate( T*, std::size_t ) noexcept {}
+
+	FrameArena* arena() const noexcept { return _arena; }
+
+	template<class O>
+	friend bool operator==( const ArenaAllocator& l, const ArenaAllocator<O>& r ) noexcept
+	{
+		return l.arena() == r.arena();
+	}
+	template<class O>
+	friend bool operator!=( const ArenaAllocator& l, const ArenaAllocator<O>& r ) noexcept
+	{
+		return l.arena() != r.arena();
+	}
+
+private:
+	FrameArena* _arena;
+};
+
+template<class U>
+using ArenaVector = std::vector<U, ArenaAllocator<U>>;
+
+// std::pmr adapter, e.g. for std::pmr::vector<UPos>
+class ArenaResource : public std::pmr::memory_resource {
+public:
+	explicit ArenaResource( FrameArena& arena ) noexcept
+		: _arena{&arena}
+	{
+	}
+
+	FrameArena& arena() const noexcept { return *_arena; }
+
+private:
+	void* do_allocate( std::size_t bytes, std::size_t alignment ) override { return _arena->allocate( bytes, alignment ); }
+	void  do_deallocate( void*, std::size_t, std::size_t ) override {}
+	bool  do_is_equal( const std::pmr::memory_resource& other ) const noexcept override
+	{
+		auto* o = dynamic_cast<const ArenaResource*>( &other );
+		return o != nullptr && o->_arena == _arena;
+	}
+
+	FrameArena* _arena;
+};
+
+// Fixed size, non owning view of arena allocated values
+template<class U>
+struct ArenaSpan {
+	U*          ptr   = nullptr;
+	std::size_t count = 0;
+
+	U*          data() const noexcept { return ptr; }
+	std::size_t size() const noexcept { return count; }
+	U*          begin() const noexcept { return ptr; }
+	U*          end() const noexcept { return ptr + count; }
+	U&          operator[]( std::size_t i ) const noexcept { return ptr[i]; }
+};
+
+// Allocates count default initialized (i.e. zero) values from the arena
+template<class U>
+ArenaSpan<U> make_arena_array( FrameArena& arena, std::size_t count )
+{
+	static_assert( std::is_trivially_destructible_v<U>, "arena memory is released without calling destructors" );
+
+	U* ptr = static_cast<U*>( arena.allocate( count * sizeof( U ), alignof( U ) ) );
+	for( std::size_t i = 0; i < count; ++i ) {
+		new( ptr + i ) U{};
+	}
+	return {ptr, count};
+}
+
+} // namespace mba::units
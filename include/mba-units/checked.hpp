@@ -0,0 +1,189 @@
+#pragma once
+
+/*
+ * Checked numerics for unit arithmetic.
+ *
+ * MBA_UNITS_CHECK_MODE selects, what happens to the results of the arithmetic operators of the unit
+ * types and of sqrt, fmod and atan2:
+ *
+ *   0 (default): nothing. MBA_UNITS_CHECKED( T, op, expr ) is just ( expr ), so the generated code
+ *                is the same as without this header.
+ *   1:           every result is checked for NaN and Inf (i.e. overflow).
+ *   2:           only every MBA_UNITS_CHECK_SAMPLE_RATE-th result per thread is checked.
+ *
+ * Non finite results are counted per thread and operation (thread_check_counters()) and across
+ * all threads (check_event_total()), the last one is kept with the dimension of its type.
+ * Nothing is recorded during constant evaluation.
+ *
+ * The mode has to be the same in all translation units of a program (e.g. set it through the
+ * MBA_UNITS_CHECK_MODE CMake variable). In modes 1 and 2 the unit types are declared in an inline
+ * namespace named after the mode (checked_all, checked_sampled_<rate>), so they are different types
+ * in translation units with a different mode: passing units between those fails to link instead of
+ * silently mixing operators compiled for different modes. MBA_UNITS_CHECK_SAMPLE_RATE therefore has
+ * to be an integer literal.
+ */
+
+#ifndef MBA_UNITS_CHECK_MODE
+#define MBA_UNITS_CHECK_MODE 0
+#endif
+
+#ifndef MBA_UNITS_CHECK_SAMPLE_RATE
+#define MBA_UNITS_CHECK_SAMPLE_RATE 64
+#endif
+
+#define MBA_UNITS_CHECK_CAT_IMPL( a, b ) a##b
+#define MBA_UNITS_CHECK_CAT( a, b ) MBA_UNITS_CHECK_CAT_IMPL( a, b )
+
+#if MBA_UNITS_CHECK_MODE == 0
+#define MBA_UNITS_CHECK_MODE_NAMESPACE_BEGIN
+#define MBA_UNITS_CHECK_MODE_NAMESPACE_END
+#elif MBA_UNITS_CHECK_MODE == 2
+#define MBA_UNITS_CHECK_MODE_NAMESPACE_BEGIN inline namespace MBA_UNITS_CHECK_CAT( checked_sampled_, MBA_UNITS_CHECK_SAMPLE_RATE ) {
+#define MBA_UNITS_CHECK_MODE_NAMESPACE_END }
+#else
+#define MBA_UNITS_CHECK_MODE_NAMESPACE_BEGIN inline namespace checked_all {
+#define MBA_UNITS_CHECK_MODE_NAMESPACE_END }
+#endif
+
+#if MBA_UNITS_CHECK_MODE == 0
+
+#define MBA_UNITS_CHECKED( T, op, expr ) ( expr )
+
+#else
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#define MBA_UNITS_CHECKED( T, op, expr ) ::mba::units::_detail_checked::check<T>( ::mba::units::CheckedOp::op, ( expr ) )
+
+namespace mba::units {
+
+template<class U>
+struct UDimension;
+
+enum class CheckedOp : unsigned char { add, subtract, multiply, divide, sqrt, fmod, atan2 };
+
+inline constexpr std::size_t checked_op_count = 7;
+
+constexpr const char* to_string( CheckedOp op ) noexcept
+{
+	constexpr const char* names[checked_op_count] = {"add", "subtract", "multiply", "divide", "sqrt", "fmod", "atan2"};
+	return names[static_cast<std::size_t>( op )];
+}
+
+// a non finite result and the base unit exponents of its type
+struct CheckEvent {
+	CheckedOp op       = CheckedOp::add;
+	int       kilogram = 0;
+	int       meter    = 0;
+	int       second   = 0;
+	bool      is_angle = false;
+	double    value    = 0.0;
+};
+
+struct CheckCounters {
+	// results, that have been inspected
+	std::uint64_t checked = 0;
+
+	// per CheckedOp
+	std::uint64_t nan[checked_op_count] = {};
+	std::uint64_t inf[checked_op_count] = {};
+
+	std::uint64_t events = 0;
+	// only valid if events != 0
+	CheckEvent last;
+};
+
+// counters of the calling thread
+inline CheckCounters& thread_check_counters() noexcept
+{
+	thread_local CheckCounters counters;
+	return counters;
+}
+
+inline void reset_thread_check_counters() noexcept
+{
+	thread_check_counters() = CheckCounters{};
+}
+
+MBA_UNITS_CHECK_MODE_NAMESPACE_BEGIN
+
+namespace _detail_checked {
+
+inline std::atomic<std::uint64_t> event_totals[checked_op_count] = {};
+
+constexpr bool is_constant_evaluated() noexcept
+{
+#if defined( __cpp_lib_is_constant_evaluated )
+	return std::is_constant_evaluated();
+#else
+	return __builtin_is_constant_evaluated();
+#endif
+}
+
+template<class T>
+void record( CheckedOp op, double v ) noexcept
+{
+	const auto i = static_cast<std::size_t>( op );
+
+	CheckCounters& c = thread_check_counters();
+	++c.events;
+	if( std::isnan( v ) ) {
+		++c.nan[i];
+	} else {
+		++c.inf[i];
+	}
+	c.last = CheckEvent{op, UDimension<T>::kilogram, UDimension<T>::meter, UDimension<T>::second, UDimension<T>::is_angle, v};
+
+	// events are rare, so contention on the shared counters doesn't matter
+	event_totals[i].fetch_add( 1, std::memory_order_relaxed );
+}
+
+inline std::uint32_t& sample_tick() noexcept
+{
+	thread_local std::uint32_t tick = 0;
+	return tick;
+}
+
+template<class T>
+inline void inspect( CheckedOp op, double v ) noexcept
+{
+#if MBA_UNITS_CHECK_MODE == 2
+	static_assert( MBA_UNITS_CHECK_SAMPLE_RATE > 0, "MBA_UNITS_CHECK_SAMPLE_RATE must be positive" );
+	std::uint32_t& tick = sample_tick();
+	if( ++tick != MBA_UNITS_CHECK_SAMPLE_RATE ) {
+		return;
+	}
+	tick = 0;
+#endif
+	++thread_check_counters().checked;
+	if( !std::isfinite( v ) ) {
+		record<T>( op, v );
+	}
+}
+
+template<class T>
+constexpr double check( CheckedOp op, double v ) noexcept
+{
+	if( !is_constant_evaluated() ) {
+		inspect<T>( op, v );
+	}
+	return v;
+}
+
+} // namespace _detail_checked
+
+MBA_UNITS_CHECK_MODE_NAMESPACE_END
+
+// non finite results of op over all threads
+inline std::uint64_t check_event_total( CheckedOp op ) noexcept
+{
+	return _detail_checked::event_totals[static_cast<std::size_t>( op )].load( std::memory_order_relaxed );
+}
+
+} // namespace mba::units
+
+#endif
@@ -0,0 +1,469 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mba::units {
+
+namespace _detail_fft {
+
+constexpr bool is_pow2( std::size_t n ) noexcept
+{
+	return n != 0 && ( n & ( n - 1 ) ) == 0;
+}
+
+constexpr std::size_t next_pow2( std::size_t n ) noexcept
+{
+	std::size_t r = 1;
+	while( r < n ) {
+		r <<= 1;
+	}
+	return r;
+}
+
+/*
+ * In-place forward complex FFT for power of two lengths on split real/imaginary arrays.
+ *
+ * Twiddles are stored per stage and contiguous, so the inner butterfly loop
+ * only does unit-stride loads and can be auto-vectorized.
+ */
+class Radix2 {
+public:
+	Radix2() = default;
+	explicit Radix2( std::size_t n )
+		: _n{n}
+		, _bitrev( n )
+	{
+		std::size_t bits = 0;
+		while( ( std::size_t{1} << bits ) < n ) {
+			++bits;
+		}
+		for( std::size_t i = 0; i < n; ++i ) {
+			std::size_t r = 0;
+			for( std::size_t b = 0; b < bits; ++b ) {
+				r |= ( ( i >> b ) & 1u ) << ( bits - 1 - b );
+			}
+			_bitrev[i] = r;
+		}
+
+		// stage with half length h uses twiddles [h-1, 2h-1)
+		_tw_re.resize( n > 1 ? n - 1 : 0 );
+		_tw_im.resize( n > 1 ? n - 1 : 0 );
+		for( std::size_t half = 1; half < n; half <<= 1 ) {
+			for( std::size_t j = 0; j < half; ++j ) {
+				const double a = -_detail_angle::pi * static_cast<double>( j ) / static_cast<double>( half );
+				_tw_re[half - 1 + j] = std::cos( a );
+				_tw_im[half - 1 + j] = std::sin( a );
+			}
+		}
+	}
+
+	std::size_t size() const noexcept { return _n; }
+
+	void forward( double* re, double* im ) const noexcept
+	{
+		for( std::size_t i = 0; i < _n; ++i ) {
+			const std::size_t r = _bitrev[i];
+			if( r > i ) {
+				std::swap( re[i], re[r] );
+				std::swap( im[i], im[r] );
+			}
+		}
+
+		for( std::size_t half = 1; half < _n; half <<= 1 ) {
+			const double* wr = _tw_re.data() + half - 1;
+			const double* wi = _tw_im.data() + half - 1;
+			for( std::size_t base = 0; base < _n; base += 2 * half ) {
+				double* ar = re + base;
+				double* ai = im + base;
+				double* br = re + base + half;
+				double* bi = im + base + half;
+				for( std::size_t j = 0; j < half; ++j ) {
+					const double tr = br[j] * wr[j] - bi[j] * wi[j];
+					const double ti = br[j] * wi[j] + bi[j] * wr[j];
+					br[j]           = ar[j] - tr;
+					bi[j]           = ai[j] - ti;
+					ar[j] += tr;
+					ai[j] += ti;
+				}
+			}
+		}
+	}
+
+private:
+	std::size_t              _n = 0;
+	std::vector<std::size_t> _bitrev;
+	std::vector<double>      _tw_re;
+	std::vector<double>      _tw_im;
+};
+
+/*
+ * Forward complex FFT of arbitrary length.
+ *
+ * Powers of two use Radix2 directly, all other lengths are mapped onto a
+ * power of two convolution (Bluestein / chirp-z).
+ */
+class ComplexFft {
+public:
+	ComplexFft() = default;
+	explicit ComplexFft( std::size_t n )
+		: _n{n}
+	{
+		if( n <= 1 || is_pow2( n ) ) {
+			_fft = Radix2( n );
+			return;
+		}
+
+		const std::size_t m = next_pow2( 2 * n - 1 );
+		_fft                = Radix2( m );
+		_chirp_re.resize( n );
+		_chirp_im.resize( n );
+		for( std::size_t k = 0; k < n; ++k ) {
+			// k^2 mod 2n keeps the argument small for large k
+			const auto   k2 = ( static_cast<unsigned long long>( k ) * k ) % ( 2ull * n );
+			const double a  = -_detail_angle::pi * static_cast<double>( k2 ) / static_cast<double>( n );
+			_chirp_re[k]    = std::cos( a );
+			_chirp_im[k]    = std::sin( a );
+		}
+
+		// spectrum of the conjugated chirp, wrapped around for negative indices
+		_kernel_re.assign( m, 0.0 );
+		_kernel_im.assign( m, 0.0 );
+		for( std::size_t k = 0; k < n; ++k ) {
+			_kernel_re[k] = _chirp_re[k];
+			_kernel_im[k] = -_chirp_im[k];
+			if( k != 0 ) {
+				_kernel_re[m - k] = _chirp_re[k];
+				_kernel_im[m - k] = -_chirp_im[k];
+			}
+		}
+		_fft.forward( _kernel_re.data(), _kernel_im.data() );
+	}
+
+	std::size_t size() const noexcept { return _n; }
+
+	// size of the scratch buffers (per real/imag part) needed by forward
+	std::size_t scratch_size() const noexcept { return _chirp_re.empty() ? 0 : _fft.size(); }
+
+	void forward( double* re, double* im, double* scratch_re, double* scratch_im ) const noexcept
+	{
+		if( _chirp_re.empty() ) {
+			_fft.forward( re, im );
+			return;
+		}
+
+		const std::size_t m = _fft.size();
+		for( std::size_t k = 0; k < _n; ++k ) {
+			scratch_re[k] = re[k] * _chirp_re[k] - im[k] * _chirp_im[k];
+			scratch_im[k] = re[k] * _chirp_im[k] + im[k] * _chirp_re[k];
+		}
+		for( std::size_t k = _n; k < m; ++k ) {
+			scratch_re[k] = 0.0;
+			scratch_im[k] = 0.0;
+		}
+		_fft.forward( scratch_re, scratch_im );
+
+		// pointwise multiplication, followed by an inverse FFT implemented as conj(fft(conj(x)))
+		for( std::size_t k = 0; k < m; ++k ) {
+			const double r = scratch_re[k] * _kernel_re[k] - scratch_im[k] * _kernel_im[k];
+			const double i = scratch_re[k] * _kernel_im[k] + scratch_im[k] * _kernel_re[k];
+			scratch_re[k]  = r;
+			scratch_im[k]  = -i;
+		}
+		_fft.forward( scratch_re, scratch_im );
+
+		const double inv_m = 1.0 / static_cast<double>( m );
+		for( std::size_t k = 0; k < _n; ++k ) {
+			const double r = scratch_re[k] * inv_m;
+			const double i = -scratch_im[k] * inv_m;
+			re[k]          = r * _chirp_re[k] - i * _chirp_im[k];
+			im[k]          = r * _chirp_im[k] + i * _chirp_re[k];
+		}
+	}
+
+private:
+	std::size_t         _n = 0;
+	Radix2              _fft;
+	std::vector<double> _chirp_re;
+	std::vector<double> _chirp_im;
+	std::vector<double> _kernel_re;
+	std::vector<double> _kernel_im;
+};
+
+} // namespace _detail_fft
+
+/*
+ * Precomputed real-input FFT of a fixed length.
+ *
+ * Even lengths are computed as a complex FFT of half the length followed by a split step,
+ * odd lengths run a full length complex FFT.
+ * A plan is immutable after construction and can be shared between threads.
+ */
+class FftPlan {
+public:
+	explicit FftPlan( std::size_t n )
+		: _n{n}
+		, _fft( n % 2 == 0 ? n / 2 : n )
+	{
+		if( n % 2 == 0 ) {
+			const std::size_t h = n / 2;
+			_split_re.resize( h + 1 );
+			_split_im.resize( h + 1 );
+			for( std::size_t k = 0; k <= h; ++k ) {
+				const double a = -2.0 * _detail_angle::pi * static_cast<double>( k ) / static_cast<double>( n );
+				_split_re[k]   = std::cos( a );
+				_split_im[k]   = std::sin( a );
+			}
+		}
+	}
+
+	// number of input samples
+	std::size_t size() const noexcept { return _n; }
+
+	// number of output frequency bins (DC up to and including Nyquist), 0 for an empty input
+	std::size_t bins() const noexcept { return _n == 0 ? 0 : _n / 2 + 1; }
+
+	/*
+	 * Computes the (unscaled) DFT bins 0 ... bins()-1 of the n values in[0], in[stride], ...
+	 * out_re/out_im must hold bins() elements.
+	 */
+	void execute( const double* in, std::size_t stride, double* out_re, double* out_im ) const
+	{
+		_execute( [in, stride]( std::size_t i ) { return in[i * stride]; }, out_re, out_im );
+	}
+
+	// Same for the values (in base units) of in[0], in[stride], ...
+	template<int k, int m, int s>
+	void execute( const Unit<k, m, s>* in, std::size_t stride, double* out_re, double* out_im ) const
+	{
+		_execute( [in, stride]( std::size_t i ) { return in[i * stride].value; }, out_re, out_im );
+	}
+
+private:
+	// sample( i ) returns the i-th input value
+	template<class Sample>
+	void _execute( Sample sample, double* out_re, double* out_im ) const
+	{
+		if( _n == 0 ) {
+			return;
+		}
+
+		thread_local std::vector<double> buffer;
+
+		const std::size_t len     = _fft.size();
+		const std::size_t scratch = _fft.scratch_size();
+		if( buffer.size() < 2 * ( len + scratch ) ) {
+			buffer.resize( 2 * ( len + scratch ) );
+		}
+		double* re  = buffer.data();
+		double* im  = re + len;
+		double* sre = im + len;
+		double* sim = sre + scratch;
+
+		if( _n % 2 != 0 ) {
+			for( std::size_t i = 0; i < len; ++i ) {
+				re[i] = sample( i );
+				im[i] = 0.0;
+			}
+			_fft.forward( re, im, sre, sim );
+			for( std::size_t k = 0; k < bins(); ++k ) {
+				out_re[k] = re[k];
+				out_im[k] = im[k];
+			}
+			return;
+		}
+
+		// pack even/odd samples into real/imaginary part of a half length sequence
+		for( std::size_t i = 0; i < len; ++i ) {
+			re[i] = sample( 2 * i );
+			im[i] = sample( 2 * i + 1 );
+		}
+		if( len > 0 ) {
+			_fft.forward( re, im, sre, sim );
+		}
+
+		for( std::size_t k = 0; k <= len; ++k ) {
+			const std::size_t a = k % len;
+			const std::size_t b = ( len - k ) % len;
+			// even part: (Z[k] + conj(Z[h-k])) / 2, odd part: (Z[k] - conj(Z[h-k])) / 2i
+			const double er = 0.5 * ( re[a] + re[b] );
+			const double ei = 0.5 * ( im[a] - im[b] );
+			const double or_ = 0.5 * ( im[a] + im[b] );
+			const double oi  = -0.5 * ( re[a] - re[b] );
+			out_re[k]        = er + _split_re[k] * or_ - _split_im[k] * oi;
+			out_im[k]        = ei + _split_re[k] * oi + _split_im[k] * or_;
+		}
+	}
+
+	std::size_t             _n;
+	_detail_fft::ComplexFft _fft;
+	std::vector<double>     _split_re;
+	std::vector<double>     _split_im;
+};
+
+// Returns a plan for length n. Plans are created once per length and shared afterwards.
+inline std::shared_ptr<const FftPlan> fft_plan( std::size_t n )
+{
+	static std::mutex                                                      mutex;
+	static std::unordered_map<std::size_t, std::shared_ptr<const FftPlan>> cache;
+
+	std::lock_guard<std::mutex> lock( mutex );
+
+	auto& plan = cache[n];
+	if( !plan ) {
+		plan = std::make_shared<const FftPlan>( n );
+	}
+	return plan;
+}
+
+/*
+ * Single sided spectrum of a real signal with values of type U, sampled every dt.
+ *
+ * amplitude(k) is the amplitude of a sinusoid at frequency(k) (same unit as the signal),
+ * power(k) its mean square contribution (summing power over all bins gives the mean square of the signal)
+ * and psd(k) the power spectral density.
+ */
+template<class U>
+class Spectrum {
+public:
+	using value_type   = U;
+	using power_type   = UMultiply_t<U, U>;
+	using density_type = UMultiply_t<power_type, UTime>;
+
+	Spectrum( std::size_t samples, UTime dt )
+		: _samples{samples}
+		, _dt{dt}
+		, _re( samples == 0 ? 0 : samples / 2 + 1 )
+		, _im( samples == 0 ? 0 : samples / 2 + 1 )
+	{
+	}
+
+	std::size_t size() const noexcept { return _re.size(); }
+	std::size_t samples() const noexcept { return _samples; }
+	UTime       sample_interval() const noexcept { return _dt; }
+
+	// distance between two bins
+	UHerz resolution() const noexcept { return 1.0 / ( static_cast<double>( _samples ) * _dt ); }
+	UHerz frequency( std::size_t k ) const noexcept { return static_cast<double>( k ) * resolution(); }
+
+	// raw, unscaled DFT value (sum over all samples)
+	std::complex<double> bin( std::size_t k ) const noexcept { return {_re[k], _im[k]}; }
+
+	U amplitude( std::size_t k ) const noexcept
+	{
+		return U{_one_sided_scale( k ) * std::sqrt( _re[k] * _re[k] + _im[k] * _im[k] ) / static_cast<double>( _samples )};
+	}
+
+	power_type power( std::size_t k ) const noexcept
+	{
+		const double n = static_cast<double>( _samples );
+		return power_type{( _one_sided_scale( k ) * ( _re[k] * _re[k] + _im[k] * _im[k] ) ) / ( n * n )};
+	}
+
+	density_type psd( std::size_t k ) const noexcept { return power( k ) / resolution(); }
+
+	UAngle phase( std::size_t k ) const noexcept { return atan2( _im[k], _re[k] ); }
+
+	std::vector<UHerz> frequencies() const { return _collect( [this]( std::size_t k ) { return frequency( k ); } ); }
+	std::vector<U>     amplitudes() const { return _collect( [this]( std::size_t k ) { return amplitude( k ); } ); }
+	std::vector<power_type> powers() const { return _collect( [this]( std::size_t k ) { return power( k ); } ); }
+
+	// direct access to the raw bins, e.g. for FftPlan::execute
+	double* real_data() noexcept { return _re.data(); }
+	double* imag_data() noexcept { return _im.data(); }
+
+private:
+	// everything but DC and Nyquist also contains the energy of the mirrored negative frequency
+	double _one_sided_scale( std::size_t k ) const noexcept
+	{
+		return ( k == 0 || 2 * k == _samples ) ? 1.0 : 2.0;
+	}
+
+	template<class F>
+	auto _collect( F f ) const
+	{
+		std::vector<decltype( f( std::size_t{} ) )> res( size() );
+		for( std::size_t k = 0; k < size(); ++k ) {
+			res[k] = f( k );
+		}
+		return res;
+	}
+
+	std::size_t         _samples;
+	UTime               _dt;
+	std::vector<double> _re;
+	std::vector<double> _im;
+};
+
+// Spectrum of n samples of a signal, that was sampled every dt
+template<int k, int m, int s>
+Spectrum<Unit<k, m, s>> rfft( const Unit<k, m, s>* samples, std::size_t n, UTime dt )
+{
+	Spectrum<Unit<k, m, s>> res( n, dt );
+	if( n == 0 ) {
+		return res;
+	}
+	fft_plan( n )->execute( samples, 1, res.real_data(), res.imag_data() );
+	return res;
+}
+
+template<int k, int m, int s>
+Spectrum<Unit<k, m, s>> rfft( const std::vector<Unit<k, m, s>>& samples, UTime dt )
+{
+	return rfft( samples.data(), samples.size(), dt );
+}
+
+/*
+ * Transforms many channels of equal length with a single plan.
+ *
+ * data holds channel c at data[c * channel_stride + i * sample_stride] (strides in elements), so both
+ * channel-major (channel_stride = n, sample_stride = 1) and interleaved layouts (channel_stride = 1,
+ * sample_stride = channels) are supported without copying.
+ */
+class FftBatchPlan {
+public:
+	FftBatchPlan( std::size_t n, std::size_t channels )
+		: _plan{fft_plan( n )}
+		, _channels{channels}
+	{
+	}
+
+	std::size_t size() const noexcept { return _plan->size(); }
+	std::size_t channels() const noexcept { return _channels; }
+
+	template<int k, int m, int s>
+	std::vector<Spectrum<Unit<k, m, s>>> execute( const Unit<k, m, s>* data,
+												  UTime                dt,
+												  std::size_t          channel_stride,
+												  std::size_t          sample_stride = 1 ) const
+	{
+		std::vector<Spectrum<Unit<k, m, s>>> res;
+		res.reserve( _channels );
+		for( std::size_t c = 0; c < _channels; ++c ) {
+			res.emplace_back( size(), dt );
+			if( size() > 0 ) {
+				_plan->execute( data + c * channel_stride, sample_stride, res.back().real_data(), res.back().imag_data() );
+			}
+		}
+		return res;
+	}
+
+	template<int k, int m, int s>
+	std::vector<Spectrum<Unit<k, m, s>>> execute( const Unit<k, m, s>* data, UTime dt ) const
+	{
+		return execute( data, dt, size(), 1 );
+	}
+
+private:
+	std::shared_ptr<const FftPlan> _plan;
+	std::size_t                    _channels;
+};
+
+} // namespace mba::units
@@ -1,6 +1,8 @@
 #pragma once
 
+#ifndef MBA_UNITS_MODULE_CORE_IMPORTED
 #include "./units.hpp"
+#endif
 
 #include <chrono>
 
@@ -0,0 +1,569 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace mba::units {
+
+// List of unit types (e.g. the elements of a state vector)
+template<class... Us>
+struct UList {
+	static constexpr std::size_t size = sizeof...( Us );
+};
+
+namespace _detail_kalman {
+
+template<std::size_t I, class L>
+struct At;
+
+template<std::size_t I, class... Us>
+struct At<I, UList<Us...>> {
+	using type = std::tuple_element_t<I, std::tuple<Us...>>;
+};
+
+template<class L>
+struct Inverse;
+
+template<class... Us>
+struct Inverse<UList<Us...>> {
+	using type = UList<UInverse_t<Us>...>;
+};
+
+template<class L, class R>
+struct IsInverse : std::false_type {
+};
+
+// true, if L_k * R_k is dimensionless for every k
+template<class... Ls, class... Rs>
+struct IsInverse<UList<Ls...>, UList<Rs...>>
+	: std::bool_constant<( sizeof...( Ls ) == sizeof...( Rs ) )
+						 && ( std::is_same_v<UMultiply_t<Ls, Rs>, Unit<0, 0, 0>> && ... )> {
+};
+
+} // namespace _detail_kalman
+
+template<std::size_t I, class L>
+using UList_at_t = typename _detail_kalman::At<I, L>::type;
+
+template<class L>
+using UListInverse_t = typename _detail_kalman::Inverse<L>::type;
+
+/*
+ * Fixed size matrix, where every element can have a different unit.
+ *
+ * Element (i, j) has the type UMultiply_t<Rows_i, Cols_j>. Every dimensionally consistent matrix
+ * (covariances, transitions, gains, ...) can be written that way. A product A * B only compiles,
+ * if A's column units are the inverse of B's row units, i.e. if every term of the sum has the same unit.
+ * Storage is a plain, row major array of doubles.
+ */
+template<class Rows, class Cols>
+class UMatrix {
+public:
+	static constexpr std::size_t rows = Rows::size;
+	static constexpr std::size_t cols = Cols::size;
+
+	using row_units = Rows;
+	using col_units = Cols;
+
+	template<std::size_t I, std::size_t J>
+	using element_type = UMultiply_t<UList_at_t<I, Rows>, UList_at_t<J, Cols>>;
+
+	constexpr UMatrix() noexcept = default;
+
+	template<std::size_t I, std::size_t J>
+	constexpr element_type<I, J> get() const noexcept
+	{
+		return element_type<I, J>{_data[I * cols + J]};
+	}
+
+	template<std::size_t I, std::size_t J>
+	constexpr void set( element_type<I, J> v ) noexcept
+	{
+		_data[I * cols + J] = v.value;
+	}
+
+	// only available for matrices, whose diagonal is dimensionless (e.g. transitions)
+	static constexpr UMatrix identity() noexcept
+	{
+		static_assert( _detail_kalman::IsInverse<Rows, Cols>::value, "diagonal elements are not dimensionless" );
+		UMatrix res;
+		for( std::size_t i = 0; i < rows; ++i ) {
+			res._data[i * cols + i] = 1.0;
+		}
+		return res;
+	}
+
+	constexpr UMatrix<Cols, Rows> transposed() const noexcept
+	{
+		UMatrix<Cols, Rows> res;
+		for( std::size_t i = 0; i < rows; ++i ) {
+			for( std::size_t j = 0; j < cols; ++j ) {
+				res.data()[j * rows + i] = _data[i * cols + j];
+			}
+		}
+		return res;
+	}
+
+	constexpr double*       data() noexcept { return _data.data(); }
+	constexpr const double* data() const noexcept { return _data.data(); }
+
+	friend constexpr UMatrix operator+( UMatrix l, const UMatrix& r ) noexcept
+	{
+		for( std::size_t i = 0; i < rows * cols; ++i ) {
+			l._data[i] += r._data[i];
+		}
+		return l;
+	}
+
+	friend constexpr UMatrix operator-( UMatrix l, const UMatrix& r ) noexcept
+	{
+		for( std::size_t i = 0; i < rows * cols; ++i ) {
+			l._data[i] -= r._data[i];
+		}
+		return l;
+	}
+
+	friend constexpr bool operator==( const UMatrix& l, const UMatrix& r ) noexcept
+	{
+		for( std::size_t i = 0; i < rows * cols; ++i ) {
+			if( l._data[i] != r._data[i] ) {
+				return false;
+			}
+		}
+		return true;
+	}
+	friend constexpr bool operator!=( const UMatrix& l, const UMatrix& r ) noexcept { return !( l == r ); }
+
+private:
+	std::array<double, Rows::size * Cols::size> _data{};
+};
+
+template<class R, class Inner, class Inner2, class C>
+constexpr auto operator*( const UMatrix<R, Inner>& l, const UMatrix<Inner2, C>& r ) noexcept -> UMatrix<R, C>
+{
+	static_assert( _detail_kalman::IsInverse<Inner, Inner2>::value,
+				   "matrix product is not dimensionally consistent: summands have different units" );
+
+	constexpr std::size_t n = Inner::size;
+	UMatrix<R, C>         res;
+	for( std::size_t i = 0; i < R::size; ++i ) {
+		for( std::size_t j = 0; j < C::size; ++j ) {
+			double sum = 0.0;
+			for( std::size_t k = 0; k < n; ++k ) {
+				sum += l.data()[i * n + k] * r.data()[k * C::size + j];
+			}
+			res.data()[i * C::size + j] = sum;
+		}
+	}
+	return res;
+}
+
+// Column vector with element types Us...
+template<class... Us>
+using UVector = UMatrix<UList<Us...>, UList<Unit<0, 0, 0>>>;
+
+namespace _detail_kalman {
+
+// In place Gauss-Jordan inversion of a row major n x n matrix. Returns false if singular.
+template<std::size_t N>
+bool invert( std::array<double, N * N>& a ) noexcept
+{
+	std::array<double, N * N> inv{};
+	for( std::size_t i = 0; i < N; ++i ) {
+		inv[i * N + i] = 1.0;
+	}
+	for( std::size_t c = 0; c < N; ++c ) {
+		std::size_t pivot = c;
+		for( std::size_t r = c + 1; r < N; ++r ) {
+			if( std::abs( a[r * N + c] ) > std::abs( a[pivot * N + c] ) ) {
+				pivot = r;
+			}
+		}
+		if( a[pivot * N + c] == 0.0 ) {
+			return false;
+		}
+		for( std::size_t k = 0; k < N; ++k ) {
+			std::swap( a[c * N + k], a[pivot * N + k] );
+			std::swap( inv[c * N + k], inv[pivot * N + k] );
+		}
+		const double d = 1.0 / a[c * N + c];
+		for( std::size_t k = 0; k < N; ++k ) {
+			a[c * N + k] *= d;
+			inv[c * N + k] *= d;
+		}
+		for( std::size_t r = 0; r < N; ++r ) {
+			if( r == c ) {
+				continue;
+			}
+			const double f = a[r * N + c];
+			for( std::size_t k = 0; k < N; ++k ) {
+				a[r * N + k] -= f * a[c * N + k];
+				inv[r * N + k] -= f * inv[c * N + k];
+			}
+		}
+	}
+	a = inv;
+	return true;
+}
+
+} // namespace _detail_kalman
+
+// Inverse of a square matrix: (Rows, Cols) -> (1/Cols, 1/Rows). Sets ok to false if the matrix is singular.
+template<class R, class C>
+auto inverse( const UMatrix<R, C>& m, bool& ok ) noexcept -> UMatrix<UListInverse_t<C>, UListInverse_t<R>>
+{
+	static_assert( R::size == C::size, "only square matrices can be inverted" );
+
+	std::array<double, R::size * R::size> a{};
+	for( std::size_t i = 0; i < a.size(); ++i ) {
+		a[i] = m.data()[i];
+	}
+	ok = _detail_kalman::invert<R::size>( a );
+
+	UMatrix<UListInverse_t<C>, UListInverse_t<R>> res;
+	for( std::size_t i = 0; i < a.size(); ++i ) {
+		res.data()[i] = a[i];
+	}
+	return res;
+}
+
+/*
+ * Linear Kalman filter with state units Xs... (State = UList<Xs...>) and measurement units Zs...
+ *
+ * All matrix types are derived from the state and measurement units, so e.g. a transition
+ * whose element (pos, speed) is not a UTime does not compile.
+ */
+template<class State, class Measurement>
+class KalmanFilter {
+public:
+	using state_type             = UMatrix<State, UList<Unit<0, 0, 0>>>;
+	using measurement_type       = UMatrix<Measurement, UList<Unit<0, 0, 0>>>;
+	using covariance_type        = UMatrix<State, State>;
+	using transition_type        = UMatrix<State, UListInverse_t<State>>;
+	using observation_type       = UMatrix<Measurement, UListInverse_t<State>>;
+	using measurement_noise_type = UMatrix<Measurement, Measurement>;
+	using gain_type              = UMatrix<State, UListInverse_t<Measurement>>;
+
+	constexpr KalmanFilter() noexcept = default;
+	constexpr KalmanFilter( const state_type& x, const covariance_type& p ) noexcept
+		: _x{x}
+		, _p{p}
+	{
+	}
+
+	constexpr const state_type&      state() const noexcept { return _x; }
+	constexpr const covariance_type& covariance() const noexcept { return _p; }
+
+	// x = F x, P = F P F^T + Q
+	constexpr void predict( const transition_type& f, const covariance_type& q ) noexcept
+	{
+		_x = f * _x;
+		_p = f * _p * f.transposed() + q;
+	}
+
+	// Incorporates measurement z. Returns false (and leaves the filter untouched) if the innovation covariance is singular.
+	bool update( const measurement_type& z, const observation_type& h, const measurement_noise_type& r ) noexcept
+	{
+		const auto y   = z - h * _x;
+		const auto pht = _p * h.transposed();
+		const auto s   = h * pht + r;
+
+		bool       ok    = false;
+		const auto s_inv = inverse( s, ok );
+		if( !ok ) {
+			return false;
+		}
+		const gain_type k = pht * s_inv;
+
+		_x = _x + k * y;
+		_p = ( transition_type::identity() - k * h ) * _p;
+		return true;
+	}
+
+private:
+	state_type      _x;
+	covariance_type _p;
+};
+
+/*
+ * Many independent Kalman filters with the same model, stepped together.
+ *
+ * Storage is structure of arrays: every matrix element is a contiguous array over all filters,
+ * so the innermost loop of every operation runs over filters and vectorizes.
+ * Transition, noise and observation matrices are shared between all filters.
+ */
+template<class State, class Measurement>
+class KalmanBatch {
+public:
+	using filter_type            = KalmanFilter<State, Measurement>;
+	using state_type             = typename filter_type::state_type;
+	using measurement_type       = typename filter_type::measurement_type;
+	using covariance_type        = typename filter_type::covariance_type;
+	using transition_type        = typename filter_type::transition_type;
+	using observation_type       = typename filter_type::observation_type;
+	using measurement_noise_type = typename filter_type::measurement_noise_type;
+
+	static constexpr std::size_t nx = State::size;
+	static constexpr std::size_t nz = Measurement::size;
+
+	explicit KalmanBatch( std::size_t count )
+		: _n{count}
+		, _x( nx * count )
+		, _p( nx * nx * count )
+		, _tmp_xx( nx * nx * count )
+		, _tmp_x( nx * count )
+		, _y( nz * count )
+		, _pht( nx * nz * count )
+		, _s( nz * nz * count )
+		, _s_inv( nz * nz * count )
+		, _k( nx * nz * count )
+		, _scratch( ( nx > nz ? nx * nx : nx * nz ) * count )
+		, _lane( count )
+	{
+	}
+
+	std::size_t size() const noexcept { return _n; }
+
+	void set( std::size_t f, const state_type& x, const covariance_type& p ) noexcept
+	{
+		for( std::size_t e = 0; e < nx; ++e ) {
+			_x[e * _n + f] = x.data()[e];
+		}
+		for( std::size_t e = 0; e < nx * nx; ++e ) {
+			_p[e * _n + f] = p.data()[e];
+		}
+	}
+
+	state_type state( std::size_t f ) const noexcept
+	{
+		state_type x;
+		for( std::size_t e = 0; e < nx; ++e ) {
+			x.data()[e] = _x[e * _n + f];
+		}
+		return x;
+	}
+
+	covariance_type covariance( std::size_t f ) const noexcept
+	{
+		covariance_type p;
+		for( std::size_t e = 0; e < nx * nx; ++e ) {
+			p.data()[e] = _p[e * _n + f];
+		}
+		return p;
+	}
+
+	void predict( const transition_type& f, const covariance_type& q ) noexcept
+	{
+		const double* F = f.data();
+
+		// x = F x
+		_mul_shared_batch( F, nx, nx, _x.data(), 1, _tmp_x.data() );
+		_x.swap( _tmp_x );
+
+		// P = F (F P)^T + Q, using the symmetry of P
+		_mul_shared_batch( F, nx, nx, _p.data(), nx, _tmp_xx.data() );
+		_transpose( _tmp_xx.data(), nx, nx );
+		_mul_shared_batch( F, nx, nx, _tmp_xx.data(), nx, _p.data() );
+		for( std::size_t e = 0; e < nx * nx; ++e ) {
+			const double qe = q.data()[e];
+			double*      p  = &_p[e * _n];
+			for( std::size_t i = 0; i < _n; ++i ) {
+				p[i] += qe;
+			}
+		}
+	}
+
+	/*
+	 * z[f] is the measurement for filter f. Filters whose innovation covariance is singular are left untouched.
+	 */
+	void update( const measurement_type* z, const observation_type& h, const measurement_noise_type& r ) noexcept
+	{
+		const double* H = h.data();
+
+		// y = z - H x
+		_mul_shared_batch( H, nz, nx, _x.data(), 1, _y.data() );
+		for( std::size_t e = 0; e < nz; ++e ) {
+			double* y = &_y[e * _n];
+			for( std::size_t i = 0; i < _n; ++i ) {
+				y[i] = z[i].data()[e] - y[i];
+			}
+		}
+
+		// P H^T = (H P)^T (P is symmetric)
+		_mul_shared_batch( H, nz, nx, _p.data(), nx, _pht.data() );
+		_transpose( _pht.data(), nz, nx );
+
+		// S = H (P H^T) + R
+		_mul_shared_batch( H, nz, nx, _pht.data(), nz, _s.data() );
+		for( std::size_t e = 0; e < nz * nz; ++e ) {
+			const double re = r.data()[e];
+			double*      s  = &_s[e * _n];
+			for( std::size_t i = 0; i < _n; ++i ) {
+				s[i] += re;
+			}
+		}
+
+		_invert_batch();
+
+		// K = P H^T S^-1
+		_mul_batch_batch( _pht.data(), nx, nz, _s_inv.data(), nz, _k.data() );
+
+		// x += K y
+		for( std::size_t row = 0; row < nx; ++row ) {
+			double* x = &_x[row * _n];
+			for( std::size_t k = 0; k < nz; ++k ) {
+				const double* kk = &_k[( row * nz + k ) * _n];
+				const double* y  = &_y[k * _n];
+				for( std::size_t i = 0; i < _n; ++i ) {
+					x[i] += kk[i] * y[i];
+				}
+			}
+		}
+
+		// P -= K (H P) = K (P H^T)^T
+		for( std::size_t row = 0; row < nx; ++row ) {
+			for( std::size_t col = 0; col < nx; ++col ) {
+				double* p = &_p[( row * nx + col ) * _n];
+				for( std::size_t k = 0; k < nz; ++k ) {
+					const double* kk  = &_k[( row * nz + k ) * _n];
+					const double* pht = &_pht[( col * nz + k ) * _n];
+					for( std::size_t i = 0; i < _n; ++i ) {
+						p[i] -= kk[i] * pht[i];
+					}
+				}
+			}
+		}
+	}
+
+private:
+	// out(rows x cols) = A(rows x inner, shared by all filters) * B(inner x cols, per filter)
+	void _mul_shared_batch(
+		const double* a, std::size_t rows, std::size_t inner, const double* b, std::size_t cols, double* out ) const noexcept
+	{
+		for( std::size_t row = 0; row < rows; ++row ) {
+			for( std::size_t col = 0; col < cols; ++col ) {
+				double* o = &out[( row * cols + col ) * _n];
+				for( std::size_t i = 0; i < _n; ++i ) {
+					o[i] = 0.0;
+				}
+				for( std::size_t k = 0; k < inner; ++k ) {
+					const double  ak = a[row * inner + k];
+					const double* bk = &b[( k * cols + col ) * _n];
+					for( std::size_t i = 0; i < _n; ++i ) {
+						o[i] += ak * bk[i];
+					}
+				}
+			}
+		}
+	}
+
+	// out(rows x cols) = A(rows x inner) * B(inner x cols), both per filter
+	void _mul_batch_batch(
+		const double* a, std::size_t rows, std::size_t inner, const double* b, std::size_t cols, double* out ) const noexcept
+	{
+		for( std::size_t row = 0; row < rows; ++row ) {
+			for( std::size_t col = 0; col < cols; ++col ) {
+				double* o = &out[( row * cols + col ) * _n];
+				for( std::size_t i = 0; i < _n; ++i ) {
+					o[i] = 0.0;
+				}
+				for( std::size_t k = 0; k < inner; ++k ) {
+					const double* ak = &a[( row * inner + k ) * _n];
+					const double* bk = &b[( k * cols + col ) * _n];
+					for( std::size_t i = 0; i < _n; ++i ) {
+						o[i] += ak[i] * bk[i];
+					}
+				}
+			}
+		}
+	}
+
+	// transposes a rows x cols matrix (per filter) by moving whole element arrays
+	void _transpose( double* m, std::size_t rows, std::size_t cols ) noexcept
+	{
+		for( std::size_t row = 0; row < rows; ++row ) {
+			for( std::size_t col = 0; col < cols; ++col ) {
+				const double* src = &m[( row * cols + col ) * _n];
+				std::copy( src, src + _n, &_scratch[( col * rows + row ) * _n] );
+			}
+		}
+		std::copy( _scratch.data(), _scratch.data() + rows * cols * _n, m );
+	}
+
+	// S_inv = S^-1 for every filter: Gauss-Jordan without pivoting (S is symmetric positive definite),
+	// executed for all filters in lockstep. Singular lanes are tracked as NaN and get a zero inverse
+	// (i.e. no correction) at the end.
+	void _invert_batch() noexcept
+	{
+		double* a   = _s.data();
+		double* inv = _s_inv.data();
+		double* tmp = _lane.data();
+
+		auto at = [this]( double* m, std::size_t row, std::size_t col ) { return &m[( row * nz + col ) * _n]; };
+
+		for( std::size_t row = 0; row < nz; ++row ) {
+			for( std::size_t col = 0; col < nz; ++col ) {
+				std::fill( at( inv, row, col ), at( inv, row, col ) + _n, row == col ? 1.0 : 0.0 );
+			}
+		}
+
+		for( std::size_t c = 0; c < nz; ++c ) {
+			const double* acc = at( a, c, c );
+			for( std::size_t i = 0; i < _n; ++i ) {
+				tmp[i] = acc[i] != 0.0 ? 1.0 / acc[i] : std::numeric_limits<double>::quiet_NaN();
+			}
+			for( std::size_t k = 0; k < nz; ++k ) {
+				double* ack = at( a, c, k );
+				double* ick = at( inv, c, k );
+				for( std::size_t i = 0; i < _n; ++i ) {
+					ack[i] *= tmp[i];
+					ick[i] *= tmp[i];
+				}
+			}
+
+			for( std::size_t r = 0; r < nz; ++r ) {
+				if( r == c ) {
+					continue;
+				}
+				std::copy( at( a, r, c ), at( a, r, c ) + _n, tmp );
+				for( std::size_t k = 0; k < nz; ++k ) {
+					double*       ark = at( a, r, k );
+					double*       irk = at( inv, r, k );
+					const double* ack = at( a, c, k );
+					const double* ick = at( inv, c, k );
+					for( std::size_t i = 0; i < _n; ++i ) {
+						ark[i] -= tmp[i] * ack[i];
+						irk[i] -= tmp[i] * ick[i];
+					}
+				}
+			}
+		}
+
+		for( std::size_t e = 0; e < nz * nz * _n; ++e ) {
+			inv[e] = std::isnan( inv[e] ) ? 0.0 : inv[e];
+		}
+	}
+
+	std::size_t         _n;
+	std::vector<double> _x;
+	std::vector<double> _p;
+	std::vector<double> _tmp_xx;
+	std::vector<double> _tmp_x;
+	std::vector<double> _y;
+	std::vector<double> _pht;
+	std::vector<double> _s;
+	std::vector<double> _s_inv;
+	std::vector<double> _k;
+	std::vector<double> _scratch;
+	std::vector<double> _lane;
+};
+
+} // namespace mba::units
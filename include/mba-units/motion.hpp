@@ -0,0 +1,211 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace mba::units {
+
+// Kinematic state on a single axis
+struct MotionState {
+	UPos   pos;
+	USpeed speed;
+	UAccel accel;
+};
+
+/*
+ * Durations of the phases of a symmetric rest-to-rest move.
+ *
+ * A move consists of an acceleration phase, a cruise phase at constant speed and a deceleration phase
+ * (same length as the acceleration phase). For jerk limited profiles, the acceleration phase starts
+ * and ends with a jerk phase each.
+ */
+struct MotionPhases {
+	UTime jerk;
+	UTime accel;
+	UTime cruise;
+
+	constexpr UTime total() const noexcept { return 2.0 * accel + cruise; }
+};
+
+/*
+ * Rest-to-rest single axis move, planned once and sampled any number of times.
+ *
+ * The profile is stored as seven segments of constant jerk. Evaluating a sample only
+ * selects the segment and evaluates a cubic - nothing is solved per sample.
+ * Positions are relative to the start of the move.
+ */
+class MotionProfile {
+public:
+	// Constant acceleration profile (infinite jerk)
+	static MotionProfile trapezoidal( UPos distance, USpeed max_speed, UAccel max_accel ) noexcept
+	{
+		const double l = std::abs( distance.value );
+		const double v = max_speed.value;
+		const double a = max_accel.value;
+
+		double ta = v / a;
+		double tv = ( l - v * v / a ) / v;
+		if( tv < 0.0 ) {
+			// max speed is not reached (triangular profile)
+			ta = std::sqrt( l / a );
+			tv = 0.0;
+		}
+		return MotionProfile( distance.value < 0.0 ? -1.0 : 1.0, 0.0, ta, tv, a, 0.0 );
+	}
+
+	// Jerk limited ("S-curve" / double S) profile
+	static MotionProfile s_curve( UPos distance, USpeed max_speed, UAccel max_accel, UJerk max_jerk ) noexcept
+	{
+		const double l = std::abs( distance.value );
+		const double v = max_speed.value;
+		const double a = max_accel.value;
+		const double j = max_jerk.value;
+
+		double tj = 0.0;
+		double ta = 0.0;
+		if( v * j < a * a ) {
+			// max acceleration is not reached before max speed
+			tj = std::sqrt( v / j );
+			ta = 2.0 * tj;
+		} else {
+			tj = a / j;
+			ta = tj + v / a;
+		}
+
+		double tv = l / v - ta;
+		if( tv < 0.0 ) {
+			// max speed is not reached
+			tv                 = 0.0;
+			tj                 = a / j;
+			const double delta = a * a * a * a / ( j * j ) + 4.0 * a * l;
+			ta                 = ( a * a / j + std::sqrt( delta ) ) / ( 2.0 * a );
+			if( ta < 2.0 * tj ) {
+				// max acceleration is not reached either
+				tj = std::cbrt( l / ( 2.0 * j ) );
+				ta = 2.0 * tj;
+			}
+		}
+		return MotionProfile( distance.value < 0.0 ? -1.0 : 1.0, tj, ta, tv, j * tj, j );
+	}
+
+	constexpr MotionPhases phases() const noexcept { return _phases; }
+	constexpr UTime        duration() const noexcept { return _phases.total(); }
+
+	// Peak speed and acceleration actually reached (<= the limits)
+	constexpr USpeed peak_speed() const noexcept { return abs( USpeed{_segments[3].v0} ); }
+	constexpr UAccel peak_accel() const noexcept { return UAccel{_peak_accel}; }
+
+	// State at time t after the start. Before the start / after the end, the start / end state is returned.
+	MotionState at( UTime t ) const noexcept
+	{
+		const double   tc = _clamp( t.value );
+		const Segment& s  = _segments[_segment_index( tc )];
+		const double   dt = tc - s.t0;
+		return MotionState{UPos{_pos( s, dt )}, USpeed{_speed( s, dt )}, UAccel{_accel( s, dt )}};
+	}
+
+	/*
+	 * Evaluates count samples at once. Any of the output pointers may be null, if that quantity is not needed.
+	 * Queries do not have to be sorted.
+	 */
+	void evaluate( const UTime* t, std::size_t count, UPos* pos, USpeed* speed, UAccel* accel ) const noexcept
+	{
+		for( std::size_t i = 0; i < count; ++i ) {
+			const double   tc = _clamp( t[i].value );
+			const Segment& s  = _segments[_segment_index( tc )];
+			const double   dt = tc - s.t0;
+			if( pos ) {
+				pos[i] = UPos{_pos( s, dt )};
+			}
+			if( speed ) {
+				speed[i] = USpeed{_speed( s, dt )};
+			}
+			if( accel ) {
+				accel[i] = UAccel{_accel( s, dt )};
+			}
+		}
+	}
+
+	void evaluate( const std::vector<UTime>& t,
+				   std::vector<UPos>&        pos,
+				   std::vector<USpeed>&      speed,
+				   std::vector<UAccel>&      accel ) const
+	{
+		pos.resize( t.size() );
+		speed.resize( t.size() );
+		accel.resize( t.size() );
+		evaluate( t.data(), t.size(), pos.data(), speed.data(), accel.data() );
+	}
+
+private:
+	// start time and start state of a segment with constant jerk
+	struct Segment {
+		double t0;
+		double p0;
+		double v0;
+		double a0;
+		double j;
+	};
+
+	MotionProfile( double sign, double tj, double ta, double tv, double a_peak, double j ) noexcept
+		: _phases{UTime{tj}, UTime{ta}, UTime{tv}}
+		, _peak_accel{a_peak}
+	{
+		const double tc = ta - 2.0 * tj; // constant acceleration part of the acceleration phase
+
+		// clang-format off
+		const std::array<double, 7> durations = { tj,  tc,     tj,     tv,  tj,  tc,      tj      };
+		const std::array<double, 7> accels    = { 0.0, a_peak, a_peak, 0.0, 0.0, -a_peak, -a_peak };
+		const std::array<double, 7> jerks     = { j,   0.0,    -j,     0.0, -j,  0.0,     j       };
+		// clang-format on
+
+		double t = 0.0;
+		double p = 0.0;
+		double v = 0.0;
+		for( std::size_t i = 0; i < 7; ++i ) {
+			Segment& s = _segments[i];
+			s          = Segment{t, sign * p, sign * v, sign * accels[i], sign * jerks[i]};
+
+			const double d = durations[i];
+			p += v * d + accels[i] * d * d / 2.0 + jerks[i] * d * d * d / 6.0;
+			v += accels[i] * d + jerks[i] * d * d / 2.0;
+			t += d;
+		}
+
+		// pin the final state, so sampling after the end returns exactly the target
+		_segments[7] = Segment{t, sign * p, 0.0, 0.0, 0.0};
+	}
+
+	double _clamp( double t ) const noexcept
+	{
+		const double end = _segments[7].t0;
+		return t < 0.0 ? 0.0 : ( t > end ? end : t );
+	}
+
+	// branchless: index of the last segment starting at or before t (empty segments are skipped that way)
+	std::size_t _segment_index( double t ) const noexcept
+	{
+		std::size_t idx = 0;
+		for( std::size_t i = 1; i < _segments.size(); ++i ) {
+			idx += static_cast<std::size_t>( t >= _segments[i].t0 );
+		}
+		return idx;
+	}
+
+	static double _pos( const Segment& s, double dt ) noexcept
+	{
+		return s.p0 + dt * ( s.v0 + dt * ( s.a0 / 2.0 + dt * s.j / 6.0 ) );
+	}
+	static double _speed( const Segment& s, double dt ) noexcept { return s.v0 + dt * ( s.a0 + dt * s.j / 2.0 ); }
+	static double _accel( const Segment& s, double dt ) noexcept { return s.a0 + dt * s.j; }
+
+	MotionPhases           _phases;
+	double                 _peak_accel;
+	std::array<Segment, 8> _segments{};
+};
+
+} // namespace mba::units
@@ -0,0 +1,599 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Pull based stream processing over unit values.
+ *
+ * A stage is any type with
+ *
+ *     using value_type = ...;
+ *     std::size_t pull( value_type* out, std::size_t max ); // returns 0 once the stream is exhausted
+ *
+ * Stages are chained with operator|. Every stage pulls at most batch_size values from its source at
+ * a time into a buffer it owns, so no stage materializes the whole stream and the working set of
+ * a chain stays in cache. The value type of each stage follows from its operation, e.g.
+ *
+ *     auto speeds = pipeline::stream( positions )
+ *                 | pipeline::moving_mean( 8 )              // UPos
+ *                 | pipeline::differentiate( 0.01_s )       // USpeed
+ *                 | pipeline::collect();                    // std::vector<USpeed>
+ */
+
+namespace mba::units::pipeline {
+
+// 1024 doubles = 8 KiB per stage buffer: a few stages fit into L1/L2 together
+inline constexpr std::size_t batch_size = 1024;
+
+template<class Stage>
+using value_type_t = typename std::decay_t<Stage>::value_type;
+
+// ######## sources #############
+
+template<class U>
+class SpanSource {
+public:
+	using value_type = U;
+
+	SpanSource( const U* data, std::size_t count ) noexcept
+		: _data{data}
+		, _count{count}
+	{
+	}
+
+	std::size_t pull( U* out, std::size_t max ) noexcept
+	{
+		const std::size_t n = std::min( max, _count - _pos );
+		std::copy_n( _data + _pos, n, out );
+		_pos += n;
+		return n;
+	}
+
+private:
+	const U*    _data;
+	std::size_t _count;
+	std::size_t _pos = 0;
+};
+
+// non owning: data must outlive the pipeline
+template<class U>
+SpanSource<U> stream( const U* data, std::size_t count ) noexcept
+{
+	return {data, count};
+}
+
+template<class U, class Alloc>
+SpanSource<U> stream( const std::vector<U, Alloc>& data ) noexcept
+{
+	return {data.data(), data.size()};
+}
+
+// ######## stages #############
+
+template<class Src, class Fn>
+class MapStage {
+public:
+	using input_type = value_type_t<Src>;
+	using value_type = std::invoke_result_t<Fn&, input_type>;
+
+	MapStage( Src src, Fn fn )
+		: _src( std::move( src ) )
+		, _fn( std::move( fn ) )
+		, _in( batch_size )
+	{
+	}
+
+	std::size_t pull( value_type* out, std::size_t max )
+	{
+		const std::size_t n = _src.pull( _in.data(), std::min( max, batch_size ) );
+		for( std::size_t i = 0; i < n; ++i ) {
+			out[i] = _fn( _in[i] );
+		}
+		return n;
+	}
+
+private:
+	Src                     _src;
+	Fn                      _fn;
+	std::vector<input_type> _in;
+};
+
+template<class Src, class Pred>
+class FilterStage {
+public:
+	using value_type = value_type_t<Src>;
+
+	FilterStage( Src src, Pred pred )
+		: _src( std::move( src ) )
+		, _pred( std::move( pred ) )
+		, _in( batch_size )
+	{
+	}
+
+	std::size_t pull( value_type* out, std::size_t max )
+	{
+		std::size_t k = 0;
+		// only a completely rejected batch may lead to a second pull; 0 must mean end of stream
+		while( k == 0 ) {
+			const std::size_t n = _src.pull( _in.data(), std::min( max, batch_size ) );
+			if( n == 0 ) {
+				return 0;
+			}
+			// branch free compaction: k <= i, so out always has room
+			for( std::size_t i = 0; i < n; ++i ) {
+				out[k] = _in[i];
+				k += static_cast<bool>( _pred( _in[i] ) );
+			}
+		}
+		return k;
+	}
+
+private:
+	Src                     _src;
+	Pred                    _pred;
+	std::vector<value_type> _in;
+};
+
+// Mean over the last `width` values. Emits nothing until the window is full.
+template<class Src>
+class MovingMeanStage {
+public:
+	using value_type = value_type_t<Src>;
+
+	MovingMeanStage( Src src, std::size_t width )
+		: _src( std::move( src ) )
+		, _in( batch_size )
+		, _ring( std::max<std::size_t>( width, 1 ) )
+	{
+	}
+
+	std::size_t pull( value_type* out, std::size_t max )
+	{
+		const std::size_t width = _ring.size();
+
+		std::size_t k = 0;
+		while( k == 0 ) {
+			const std::size_t n = _src.pull( _in.data(), std::min( max, batch_size ) );
+			if( n == 0 ) {
+				return 0;
+			}
+			for( std::size_t i = 0; i < n; ++i ) {
+				_sum += _in[i] - _ring[_pos];
+				_ring[_pos] = _in[i];
+				if( ++_pos == width ) {
+					_pos = 0;
+					// recompute once per revolution, so rounding errors of the running sum don't accumulate
+					_sum = value_type{};
+					for( const auto& v : _ring ) {
+						_sum += v;
+					}
+				}
+				_filled = std::min( _filled + 1, width );
+
+				out[k] = _sum / static_cast<double>( width );
+				k += _filled == width;
+			}
+		}
+		return k;
+	}
+
+private:
+	Src                     _src;
+	std::vector<value_type> _in;
+	std::vector<value_type> _ring;
+	value_type              _sum{};
+	std::size_t             _pos    = 0;
+	std::size_t             _filled = 0;
+};
+
+// Finite difference of a stream sampled every dt: (x[i] - x[i-1]) / dt
+template<class Src>
+class DifferentiateStage {
+public:
+	using input_type = value_type_t<Src>;
+	using value_type = UDivide_t<input_type, UTime>;
+
+	DifferentiateStage( Src src, UTime dt )
+		: _src( std::move( src ) )
+		, _dt{dt}
+		, _in( batch_size )
+	{
+	}
+
+	std::size_t pull( value_type* out, std::size_t max )
+	{
+		std::size_t k = 0;
+		while( k == 0 ) {
+			const std::size_t n = _src.pull( _in.data(), std::min( max, batch_size ) );
+			if( n == 0 ) {
+				return 0;
+			}
+			std::size_t i = 0;
+			if( !_has_prev ) {
+				_prev     = _in[0];
+				_has_prev = true;
+				i         = 1;
+			}
+			for( ; i < n; ++i ) {
+				out[k++] = ( _in[i] - _prev ) / _dt;
+				_prev    = _in[i];
+			}
+		}
+		return k;
+	}
+
+private:
+	Src                     _src;
+	UTime                   _dt;
+	std::vector<input_type> _in;
+	input_type              _prev{};
+	bool                    _has_prev = false;
+};
+
+// Linear interpolation of a stream sampled every in_dt to a sampling period of out_dt.
+// The first output coincides with the first input, no output is extrapolated past the last input.
+// Throws std::invalid_argument, unless out_dt / in_dt is positive and finite.
+template<class Src>
+class ResampleStage {
+public:
+	using value_type = value_type_t<Src>;
+
+	ResampleStage( Src src, UTime in_dt, UTime out_dt )
+		: _src( std::move( src ) )
+		, _step{out_dt / in_dt}
+		, _in( batch_size )
+	{
+		// a step of 0 (or NaN) would never advance past an input sample
+		if( !( _step.value > 0.0 ) || !std::isfinite( _step.value ) ) {
+			throw std::invalid_argument( "pipeline::resample: out_dt / in_dt must be positive and finite" );
+		}
+	}
+
+	std::size_t pull( value_type* out, std::size_t max )
+	{
+		std::size_t k = 0;
+		while( k < max ) {
+			if( _pos == _count ) {
+				_count = _src.pull( _in.data(), batch_size );
+				_pos   = 0;
+				if( _count == 0 ) {
+					// a single input sample has no interval after it, but it still is the first output
+					if( _has_prev && _out_index == 0 ) {
+						out[k++] = _prev;
+						++_out_index;
+					}
+					break;
+				}
+			}
+			if( !_has_prev ) {
+				_prev     = _in[_pos++];
+				_has_prev = true;
+				continue;
+			}
+
+			// emit all output samples within [prev, next]
+			const value_type next  = _in[_pos];
+			const value_type delta = next - _prev;
+			for( ;; ) {
+				// computed from the counters instead of accumulated, so there is no drift over long streams
+				const double phase = static_cast<double>( _out_index ) * _step.value - static_cast<double>( _in_index );
+				if( phase > 1.0 + _boundary_tolerance ) {
+					_prev = next;
+					++_in_index;
+					++_pos;
+					break;
+				}
+				if( k == max ) {
+					break;
+				}
+				out[k++] = _prev + delta * phase;
+				++_out_index;
+			}
+		}
+		return k;
+	}
+
+private:
+	Src                     _src;
+	UNone                   _step;
+	std::vector<value_type> _in;
+	std::size_t             _pos   = 0;
+	std::size_t             _count = 0;
+	value_type              _prev{};
+	bool                    _has_prev = false;
+	// number of emitted samples and index of _prev in the input stream
+	std::size_t _out_index = 0;
+	std::size_t _in_index  = 0;
+
+	// output samples this close (in input samples) past an input sample still count as on it
+	static constexpr double _boundary_tolerance = 1e-9;
+};
+
+/*
+ * Runs the upstream part of a pipeline on its own thread.
+ *
+ * The worker pulls batches from the source and hands them over through a queue of at most
+ * `depth` batches, so the stages before and after run concurrently. Exceptions thrown on the
+ * worker are rethrown from pull().
+ */
+template<class Src>
+class ThreadedStage {
+public:
+	using value_type = value_type_t<Src>;
+
+	ThreadedStage( Src src, std::size_t depth )
+		: _shared{std::make_unique<Shared>()}
+	{
+		_shared->depth = std::max<std::size_t>( depth, 1 );
+		_worker        = std::thread( [s = _shared.get(), src = std::move( src )]() mutable { _produce( *s, src ); } );
+	}
+
+	ThreadedStage( ThreadedStage&& ) noexcept = default;
+	ThreadedStage& operator=( ThreadedStage&& ) = delete;
+
+	~ThreadedStage()
+	{
+		if( _worker.joinable() ) {
+			{
+				std::lock_guard<std::mutex> lock( _shared->mutex );
+				_shared->stop = true;
+			}
+			_shared->not_full.notify_one();
+			_worker.join();
+		}
+	}
+
+	std::size_t pull( value_type* out, std::size_t max )
+	{
+		if( _pos == _current.size() ) {
+			if( _done || !_next_batch() ) {
+				return 0;
+			}
+		}
+		const std::size_t n = std::min( max, _current.size() - _pos );
+		std::copy_n( _current.data() + _pos, n, out );
+		_pos += n;
+		return n;
+	}
+
+private:
+	struct Shared {
+		std::mutex                           mutex;
+		std::condition_variable              not_full;
+		std::condition_variable              not_empty;
+		std::deque<std::vector<value_type>>  full;
+		std::vector<std::vector<value_type>> free;
+		std::size_t                          depth = 1;
+		bool                                 stop  = false;
+		std::exception_ptr                   error;
+	};
+
+	// an empty batch marks the end of the stream
+	static void _produce( Shared& s, Src& src )
+	{
+		try {
+			for( ;; ) {
+				std::vector<value_type> batch;
+				{
+					std::lock_guard<std::mutex> lock( s.mutex );
+					if( !s.free.empty() ) {
+						batch = std::move( s.free.back() );
+						s.free.pop_back();
+					}
+				}
+				batch.resize( batch_size );
+				batch.resize( src.pull( batch.data(), batch_size ) );
+				const bool last = batch.empty();
+
+				std::unique_lock<std::mutex> lock( s.mutex );
+				s.not_full.wait( lock, [&] { return s.stop || s.full.size() < s.depth; } );
+				if( s.stop ) {
+					return;
+				}
+				s.full.push_back( std::move( batch ) );
+				lock.unlock();
+				s.not_empty.notify_one();
+				if( last ) {
+					return;
+				}
+			}
+		} catch( ... ) {
+			{
+				std::lock_guard<std::mutex> lock( s.mutex );
+				s.error = std::current_exception();
+				s.full.emplace_back();
+			}
+			s.not_empty.notify_one();
+		}
+	}
+
+	bool _next_batch()
+	{
+		std::unique_lock<std::mutex> lock( _shared->mutex );
+		if( _current.capacity() != 0 ) {
+			_shared->free.push_back( std::move( _current ) );
+		}
+		_shared->not_empty.wait( lock, [&] { return !_shared->full.empty(); } );
+		_current = std::move( _shared->full.front() );
+		_shared->full.pop_front();
+		_pos = 0;
+		lock.unlock();
+		_shared->not_full.notify_one();
+
+		if( _current.empty() ) {
+			_done = true;
+			if( _shared->error ) {
+				std::rethrow_exception( _shared->error );
+			}
+			return false;
+		}
+		return true;
+	}
+
+	std::unique_ptr<Shared> _shared;
+	std::thread             _worker;
+	std::vector<value_type> _current;
+	std::size_t             _pos  = 0;
+	bool                    _done = false;
+};
+
+// ######## sinks #############
+
+template<class Stage>
+std::vector<value_type_t<Stage>> collect( Stage&& stage )
+{
+	std::vector<value_type_t<Stage>> result;
+	std::size_t                      size = 0;
+	for( ;; ) {
+		result.resize( size + batch_size );
+		const std::size_t n = stage.pull( result.data() + size, batch_size );
+		size += n;
+		if( n == 0 ) {
+			break;
+		}
+	}
+	result.resize( size );
+	return result;
+}
+
+// calls fn( const value_type* data, std::size_t count ) once per batch
+template<class Stage, class Fn>
+void for_each_batch( Stage&& stage, Fn&& fn )
+{
+	std::vector<value_type_t<Stage>> batch( batch_size );
+	while( const std::size_t n = stage.pull( batch.data(), batch_size ) ) {
+		fn( static_cast<const value_type_t<Stage>*>( batch.data() ), n );
+	}
+}
+
+// ######## adaptors for operator| #############
+
+namespace _detail_pipeline {
+
+template<class Fn>
+struct Map {
+	Fn fn;
+};
+
+template<class Pred>
+struct Filter {
+	Pred pred;
+};
+
+struct MovingMean {
+	std::size_t width;
+};
+
+struct Differentiate {
+	UTime dt;
+};
+
+struct Resample {
+	UTime in_dt;
+	UTime out_dt;
+};
+
+struct Threaded {
+	std::size_t depth;
+};
+
+struct Collect {
+};
+
+template<class Src, class Fn>
+MapStage<std::decay_t<Src>, Fn> operator|( Src&& src, Map<Fn> a )
+{
+	return {std::forward<Src>( src ), std::move( a.fn )};
+}
+
+template<class Src, class Pred>
+FilterStage<std::decay_t<Src>, Pred> operator|( Src&& src, Filter<Pred> a )
+{
+	return {std::forward<Src>( src ), std::move( a.pred )};
+}
+
+template<class Src>
+MovingMeanStage<std::decay_t<Src>> operator|( Src&& src, MovingMean a )
+{
+	return {std::forward<Src>( src ), a.width};
+}
+
+template<class Src>
+DifferentiateStage<std::decay_t<Src>> operator|( Src&& src, Differentiate a )
+{
+	return {std::forward<Src>( src ), a.dt};
+}
+
+template<class Src>
+ResampleStage<std::decay_t<Src>> operator|( Src&& src, Resample a )
+{
+	return {std::forward<Src>( src ), a.in_dt, a.out_dt};
+}
+
+template<class Src>
+ThreadedStage<std::decay_t<Src>> operator|( Src&& src, Threaded a )
+{
+	return {std::forward<Src>( src ), a.depth};
+}
+
+template<class Src>
+auto operator|( Src&& src, Collect )
+{
+	return pipeline::collect( std::forward<Src>( src ) );
+}
+
+} // namespace _detail_pipeline
+
+template<class Fn>
+_detail_pipeline::Map<Fn> map( Fn fn )
+{
+	return {std::move( fn )};
+}
+
+template<class Pred>
+_detail_pipeline::Filter<Pred> filter( Pred pred )
+{
+	return {std::move( pred )};
+}
+
+inline _detail_pipeline::MovingMean moving_mean( std::size_t width )
+{
+	return {width};
+}
+
+inline _detail_pipeline::Differentiate differentiate( UTime dt )
+{
+	return {dt};
+}
+
+inline _detail_pipeline::Resample resample( UTime in_dt, UTime out_dt )
+{
+	return {in_dt, out_dt};
+}
+
+// everything left of this stage runs on a separate thread, buffering up to depth batches
+inline _detail_pipeline::Threaded threaded( std::size_t depth = 4 )
+{
+	return {depth};
+}
+
+inline _detail_pipeline::Collect collect()
+{
+	return {};
+}
+
+} // namespace mba::units::pipeline
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mba::units {
+
+// type of the i-th coefficient of a polynomial X -> Y: Y / X^i
+template<class Y, class X, std::size_t I>
+using UPolynomialCoefficient_t = UDivide_t<Y, UPower_t<X, static_cast<int>( I )>>;
+
+namespace _detail_polynomial {
+
+template<class Y, class X, class... Cs, std::size_t... I>
+constexpr bool coefficients_match( std::index_sequence<I...> ) noexcept
+{
+	return ( std::is_same_v<Cs, UPolynomialCoefficient_t<Y, X, I>> && ... );
+}
+
+} // namespace _detail_polynomial
+
+// true, if Cs... are valid coefficient types (in ascending order) for a polynomial X -> Y
+template<class Y, class X, class... Cs>
+inline constexpr bool coefficients_match_v
+	= _detail_polynomial::coefficients_match<Y, X, Cs...>( std::make_index_sequence<sizeof...( Cs )>{} );
+
+/*
+ * Polynomial c0 + c1 * x + ... + cN * x^N of compile time degree N, mapping X to Y.
+ *
+ * Coefficient i has type Y / X^i, which is checked at compile time, e.g. for a position over time:
+ *
+ *     Polynomial<UPos, UTime, 2> p{ x0, v0, a / 2.0 }; // UPos, USpeed, UAccel
+ */
+template<class Y, class X, std::size_t Degree>
+class Polynomial {
+public:
+	static constexpr std::size_t degree = Degree;
+
+	template<std::size_t I>
+	using coefficient_type = UPolynomialCoefficient_t<Y, X, I>;
+
+	using derivative_type = Polynomial<UDivide_t<Y, X>, X, ( Degree == 0 ? 0 : Degree - 1 )>;
+	using integral_type   = Polynomial<UMultiply_t<Y, X>, X, Degree + 1>;
+
+	// all coefficients zero
+	constexpr Polynomial() noexcept = default;
+
+	template<class... Cs,
+			 class = std::enable_if_t<sizeof...( Cs ) == Degree + 1
+									  && std::conjunction_v<std::negation<std::is_same<Cs, Polynomial>>...>>>
+	constexpr Polynomial( Cs... coefficients ) noexcept
+		: _c{coefficients.value...}
+	{
+		static_assert( coefficients_match_v<Y, X, Cs...>, "coefficient i must have the dimension Y / X^i" );
+	}
+
+	template<std::size_t I>
+	constexpr coefficient_type<I> get() const noexcept
+	{
+		static_assert( I <= Degree );
+		return coefficient_type<I>{_c[I]};
+	}
+
+	template<std::size_t I>
+	constexpr void set( coefficient_type<I> c ) noexcept
+	{
+		static_assert( I <= Degree );
+		_c[I] = c.value;
+	}
+
+	constexpr Y operator()( X x ) const noexcept { return horner( x ); }
+
+	// N multiplications and additions, each depending on the previous one
+	constexpr Y horner( X x ) const noexcept
+	{
+		double y = _c[Degree];
+		for( std::size_t i = Degree; i-- > 0; ) {
+			y = y * x.value + _c[i];
+		}
+		return Y{y};
+	}
+
+	// Same result up to rounding, but evaluates pairs of coefficients independently
+	// (depth log2(N) instead of N), which helps for higher degrees on out of order cores.
+	constexpr Y estrin( X x ) const noexcept
+	{
+		std::array<double, Degree + 1> t = _c;
+
+		double      p = x.value;
+		std::size_t n = Degree + 1;
+		while( n > 1 ) {
+			for( std::size_t j = 0; j < n / 2; ++j ) {
+				t[j] = t[2 * j] + t[2 * j + 1] * p;
+			}
+			if( n % 2 == 1 ) {
+				t[n / 2] = t[n - 1];
+			}
+			n = ( n + 1 ) / 2;
+			p = p * p;
+		}
+		return Y{t[0]};
+	}
+
+	// y[i] = p( x[i] ) for i in [0, count). The loop is over independent samples, so it can be vectorized.
+	void evaluate( const X* x, Y* y, std::size_t count ) const noexcept
+	{
+		const std::array<double, Degree + 1> c = _c;
+		for( std::size_t i = 0; i < count; ++i ) {
+			double v = c[Degree];
+			for( std::size_t j = Degree; j-- > 0; ) {
+				v = v * x[i].value + c[j];
+			}
+			y[i].value = v;
+		}
+	}
+
+	template<class Alloc>
+	std::vector<Y> evaluate( const std::vector<X, Alloc>& x ) const
+	{
+		std::vector<Y> y( x.size() );
+		evaluate( x.data(), y.data(), x.size() );
+		return y;
+	}
+
+	constexpr derivative_type derivative() const noexcept
+	{
+		derivative_type d;
+		for( std::size_t i = 0; i < Degree; ++i ) {
+			d._c[i] = static_cast<double>( i + 1 ) * _c[i + 1];
+		}
+		return d;
+	}
+
+	// antiderivative with the given value at x = 0
+	constexpr integral_type integral( UMultiply_t<Y, X> constant = {} ) const noexcept
+	{
+		integral_type r;
+		r._c[0] = constant.value;
+		for( std::size_t i = 0; i <= Degree; ++i ) {
+			r._c[i + 1] = _c[i] / static_cast<double>( i + 1 );
+		}
+		return r;
+	}
+
+	friend constexpr Polynomial operator+( const Polynomial& l, const Polynomial& r ) noexcept
+	{
+		Polynomial p;
+		for( std::size_t i = 0; i <= Degree; ++i ) {
+			p._c[i] = l._c[i] + r._c[i];
+		}
+		return p;
+	}
+
+	friend constexpr Polynomial operator-( const Polynomial& l, const Polynomial& r ) noexcept
+	{
+		Polynomial p;
+		for( std::size_t i = 0; i <= Degree; ++i ) {
+			p._c[i] = l._c[i] - r._c[i];
+		}
+		return p;
+	}
+
+	friend constexpr bool operator==( const Polynomial& l, const Polynomial& r ) noexcept
+	{
+		for( std::size_t i = 0; i <= Degree; ++i ) {
+			if( l._c[i] != r._c[i] ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	friend constexpr bool operator!=( const Polynomial& l, const Polynomial& r ) noexcept { return !( l == r ); }
+
+private:
+	template<class, class, std::size_t>
+	friend class Polynomial;
+
+	// coefficients in base units
+	std::array<double, Degree + 1> _c{};
+};
+
+// Deduces Y from the first coefficient and the degree from the number of coefficients:
+// make_polynomial<UTime>( x0, v0, a / 2.0 ) -> Polynomial<UPos, UTime, 2>
+template<class X, class C0, class... Cs>
+constexpr Polynomial<C0, X, sizeof...( Cs )> make_polynomial( C0 c0, Cs... cs ) noexcept
+{
+	return {c0, cs...};
+}
+
+} // namespace mba::units
@@ -0,0 +1,423 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace mba::units {
+
+/*
+ * How a reader waits for new records.
+ *
+ * polling: spins (with yield) on the write index, lowest latency, burns a core
+ * futex:   sleeps in the kernel until the writer publishes (Linux only)
+ */
+enum class WaitMode : std::uint32_t { polling = 0, futex = 1 };
+
+// Fixed layout record of unit values, stored as plain doubles
+template<class... Us>
+struct UnitRecord {
+	static constexpr std::size_t field_count = sizeof...( Us );
+
+	template<std::size_t I>
+	using field_type = std::tuple_element_t<I, std::tuple<Us...>>;
+
+	double values[field_count];
+
+	template<std::size_t I>
+	constexpr field_type<I> get() const noexcept
+	{
+		return field_type<I>{values[I]};
+	}
+
+	template<std::size_t I>
+	constexpr void set( field_type<I> v ) noexcept
+	{
+		values[I] = v.value;
+	}
+};
+
+namespace _detail_shm {
+
+constexpr std::uint64_t magic      = 0x4d42'4155'4e49'5453; // "MBAUNITS"
+constexpr std::uint32_t version    = 1;
+constexpr std::size_t   max_fields = 32;
+constexpr std::size_t   cache_line = 64;
+
+// dimension of one record field, as stored in shared memory
+struct FieldSchema {
+	std::int32_t kilogram;
+	std::int32_t meter;
+	std::int32_t second;
+	std::int32_t is_angle;
+
+	friend bool operator==( const FieldSchema& l, const FieldSchema& r ) noexcept
+	{
+		return l.kilogram == r.kilogram && l.meter == r.meter && l.second == r.second && l.is_angle == r.is_angle;
+	}
+	friend bool operator!=( const FieldSchema& l, const FieldSchema& r ) noexcept { return !( l == r ); }
+};
+
+template<class U>
+constexpr FieldSchema field_schema() noexcept
+{
+	using D = UDimension<U>;
+	return FieldSchema{D::kilogram, D::meter, D::second, D::is_angle ? 1 : 0};
+}
+
+inline std::string to_string( const FieldSchema& f )
+{
+	if( f.is_angle ) {
+		return "rad";
+	}
+	return "kg^" + std::to_string( f.kilogram ) + "_m^" + std::to_string( f.meter ) + "_s^"
+		   + std::to_string( f.second );
+}
+
+static_assert( std::atomic<std::uint64_t>::is_always_lock_free, "shared memory channel requires lock free atomics" );
+static_assert( std::atomic<std::uint32_t>::is_always_lock_free, "shared memory channel requires lock free atomics" );
+
+// Beginning of the shared memory segment, records follow at data_offset
+struct Header {
+	std::atomic<std::uint64_t> magic; // written last by the creator
+	std::uint32_t              version;
+	std::uint32_t              wait_mode;
+	std::uint64_t              capacity; // in records, power of two
+	std::uint32_t              record_size;
+	std::uint32_t              field_count;
+	FieldSchema                fields[max_fields];
+
+	alignas( cache_line ) std::atomic<std::uint64_t> write_index;
+	alignas( cache_line ) std::atomic<std::uint64_t> read_index;
+
+	// futex word: incremented on every publish, readers sleep on it
+	alignas( cache_line ) std::atomic<std::uint32_t> sequence;
+	std::atomic<std::uint32_t> sleepers;
+};
+
+constexpr std::size_t data_offset = ( sizeof( Header ) + cache_line - 1 ) / cache_line * cache_line;
+
+inline void futex_wake_all( std::atomic<std::uint32_t>& word ) noexcept
+{
+#if defined( __linux__ )
+	syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( &word ), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0 );
+#else
+	(void)word;
+#endif
+}
+
+[[noreturn]] inline void throw_errno( const char* what )
+{
+	throw std::system_error( errno, std::generic_category(), what );
+}
+
+// Owns a mapping of a POSIX shared memory object
+class Mapping {
+public:
+	Mapping() = default;
+	Mapping( void* addr, std::size_t size ) noexcept
+		: _addr{addr}
+		, _size{size}
+	{
+	}
+	Mapping( Mapping&& other ) noexcept
+		: _addr{std::exchange( other._addr, nullptr )}
+		, _size{other._size}
+	{
+	}
+	Mapping& operator=( Mapping&& other ) noexcept
+	{
+		std::swap( _addr, other._addr );
+		std::swap( _size, other._size );
+		return *this;
+	}
+	~Mapping()
+	{
+		if( _addr ) {
+			::munmap( _addr, _size );
+		}
+	}
+
+	Header*        header() const noexcept { return static_cast<Header*>( _addr ); }
+	unsigned char* data() const noexcept { return static_cast<unsigned char*>( _addr ) + data_offset; }
+
+private:
+	void*       _addr = nullptr;
+	std::size_t _size = 0;
+};
+
+inline Mapping map_fd( int fd, std::size_t size )
+{
+	void* addr = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	::close( fd );
+	if( addr == MAP_FAILED ) {
+		throw_errno( "mmap" );
+	}
+	return Mapping( addr, size );
+}
+
+} // namespace _detail_shm
+
+/*
+ * Producer side of a single-producer/single-consumer ring buffer of UnitRecord<Us...> in POSIX shared memory.
+ *
+ * The segment starts with a schema header recording the dimension of every field,
+ * which readers check once on attach. Records are written in place - no serialization.
+ * The writer creates the shared memory object and unlinks it again on destruction.
+ */
+template<class... Us>
+class ShmWriter {
+public:
+	using record_type = UnitRecord<Us...>;
+
+	static_assert( sizeof...( Us ) <= _detail_shm::max_fields, "too many fields" );
+	static_assert( sizeof( record_type ) == sizeof...( Us ) * sizeof( double ) );
+
+	// name must start with '/', capacity is rounded up to a power of two
+	ShmWriter( std::string name, std::size_t capacity, WaitMode mode = WaitMode::polling )
+		: _name{std::move( name )}
+	{
+#if !defined( __linux__ )
+		if( mode == WaitMode::futex ) {
+			throw std::invalid_argument( "WaitMode::futex is only supported on linux" );
+		}
+#endif
+		std::size_t cap = 1;
+		while( cap < capacity ) {
+			cap <<= 1;
+		}
+
+		const int fd = ::shm_open( _name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+		if( fd < 0 ) {
+			_detail_shm::throw_errno( "shm_open" );
+		}
+		const std::size_t size = _detail_shm::data_offset + cap * sizeof( record_type );
+		if( ::ftruncate( fd, static_cast<off_t>( size ) ) != 0 ) {
+			const int err = errno;
+			::close( fd );
+			::shm_unlink( _name.c_str() );
+			throw std::system_error( err, std::generic_category(), "ftruncate" );
+		}
+		try {
+			_map = _detail_shm::map_fd( fd, size );
+		} catch( ... ) {
+			::shm_unlink( _name.c_str() );
+			throw;
+		}
+
+		auto* h = new( _map.header() ) _detail_shm::Header{};
+		h->version     = _detail_shm::version;
+		h->wait_mode   = static_cast<std::uint32_t>( mode );
+		h->capacity    = cap;
+		h->record_size = static_cast<std::uint32_t>( sizeof( record_type ) );
+		h->field_count = static_cast<std::uint32_t>( sizeof...( Us ) );
+		std::size_t i  = 0;
+		( ( h->fields[i++] = _detail_shm::field_schema<Us>() ), ... );
+		h->magic.store( _detail_shm::magic, std::memory_order_release );
+
+		_records = reinterpret_cast<record_type*>( _map.data() );
+		_mask    = cap - 1;
+	}
+
+	ShmWriter( const ShmWriter& ) = delete;
+	ShmWriter& operator=( const ShmWriter& ) = delete;
+
+	~ShmWriter() { ::shm_unlink( _name.c_str() ); }
+
+	const std::string& name() const noexcept { return _name; }
+	std::size_t        capacity() const noexcept { return _mask + 1; }
+
+	// Slot for the next record, to be filled in place and made visible with publish(). nullptr if full.
+	record_type* try_claim() noexcept
+	{
+		auto*      h = _map.header();
+		const auto w = h->write_index.load( std::memory_order_relaxed );
+		if( w - h->read_index.load( std::memory_order_acquire ) > _mask ) {
+			return nullptr;
+		}
+		return &_records[w & _mask];
+	}
+
+	void publish() noexcept
+	{
+		auto* h = _map.header();
+		h->write_index.store( h->write_index.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+		if( h->wait_mode == static_cast<std::uint32_t>( WaitMode::futex ) ) {
+			h->sequence.fetch_add( 1, std::memory_order_seq_cst );
+			if( h->sleepers.load( std::memory_order_seq_cst ) != 0 ) {
+				_detail_shm::futex_wake_all( h->sequence );
+			}
+		}
+	}
+
+	// Returns false if the channel is full
+	bool try_write( Us... values ) noexcept
+	{
+		record_type* slot = try_claim();
+		if( !slot ) {
+			return false;
+		}
+		*slot = record_type{{values.value...}};
+		publish();
+		return true;
+	}
+
+private:
+	std::string          _name;
+	_detail_shm::Mapping _map;
+	record_type*         _records = nullptr;
+	std::size_t          _mask    = 0;
+};
+
+/*
+ * Consumer side of a channel created by ShmWriter<Us...>.
+ *
+ * Attaching checks once, that the recorded schema matches Us... exactly (std::runtime_error otherwise).
+ * Afterwards, records are read in place from shared memory.
+ */
+template<class... Us>
+class ShmReader {
+public:
+	using record_type = UnitRecord<Us...>;
+
+	explicit ShmReader( const std::string& name )
+	{
+		const int fd = ::shm_open( name.c_str(), O_RDWR, 0 );
+		if( fd < 0 ) {
+			_detail_shm::throw_errno( "shm_open" );
+		}
+		struct stat st {};
+		if( ::fstat( fd, &st ) != 0 ) {
+			const int err = errno;
+			::close( fd );
+			throw std::system_error( err, std::generic_category(), "fstat" );
+		}
+		const auto size = static_cast<std::size_t>( st.st_size );
+		if( size < _detail_shm::data_offset ) {
+			::close( fd );
+			throw std::runtime_error( "shared memory channel '" + name + "' is not initialized" );
+		}
+		_map = _detail_shm::map_fd( fd, size );
+
+		const auto* h = _map.header();
+		if( h->magic.load( std::memory_order_acquire ) != _detail_shm::magic || h->version != _detail_shm::version ) {
+			throw std::runtime_error( "shared memory channel '" + name + "' has an unknown format" );
+		}
+		if( h->field_count != sizeof...( Us ) || h->record_size != sizeof( record_type ) ) {
+			throw std::runtime_error( "shared memory channel '" + name + "' has " + std::to_string( h->field_count )
+									  + " fields, reader expects " + std::to_string( sizeof...( Us ) ) );
+		}
+		if( size < _detail_shm::data_offset + h->capacity * sizeof( record_type ) ) {
+			throw std::runtime_error( "shared memory channel '" + name + "' is truncated" );
+		}
+
+		const _detail_shm::FieldSchema expected[] = {_detail_shm::field_schema<Us>()...};
+		for( std::size_t i = 0; i < sizeof...( Us ); ++i ) {
+			if( h->fields[i] != expected[i] ) {
+				throw std::runtime_error( "shared memory channel '" + name + "': field " + std::to_string( i ) + " is "
+										  + _detail_shm::to_string( h->fields[i] ) + ", reader expects "
+										  + _detail_shm::to_string( expected[i] ) );
+			}
+		}
+
+		_records = reinterpret_cast<const record_type*>( _map.data() );
+		_mask    = h->capacity - 1;
+	}
+
+	WaitMode wait_mode() const noexcept { return static_cast<WaitMode>( _map.header()->wait_mode ); }
+
+	// Oldest unread record (in shared memory) or nullptr. Stays valid until pop().
+	const record_type* peek() const noexcept
+	{
+		auto*      h = _map.header();
+		const auto r = h->read_index.load( std::memory_order_relaxed );
+		if( r == h->write_index.load( std::memory_order_acquire ) ) {
+			return nullptr;
+		}
+		return &_records[r & _mask];
+	}
+
+	// Releases the record returned by peek() to the writer
+	void pop() noexcept
+	{
+		auto* h = _map.header();
+		h->read_index.store( h->read_index.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	}
+
+	// Like peek(), but waits (according to the channel's WaitMode) up to timeout for a record
+	template<class Rep, class Period>
+	const record_type* wait( std::chrono::duration<Rep, Period> timeout ) const
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		auto*      h        = _map.header();
+		while( true ) {
+			const auto seq = h->sequence.load( std::memory_order_seq_cst );
+			if( const record_type* rec = peek() ) {
+				return rec;
+			}
+			if( std::chrono::steady_clock::now() >= deadline ) {
+				return nullptr;
+			}
+			if( wait_mode() == WaitMode::futex ) {
+				// woken by publish, or periodically to check the deadline
+				h->sleepers.fetch_add( 1, std::memory_order_seq_cst );
+				if( !peek() ) {
+					_futex_wait_for( h->sequence, seq, deadline );
+				}
+				h->sleepers.fetch_sub( 1, std::memory_order_seq_cst );
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	static void _futex_wait_for( std::atomic<std::uint32_t>&           word,
+								 std::uint32_t                         expected,
+								 std::chrono::steady_clock::time_point deadline ) noexcept
+	{
+#if defined( __linux__ )
+		const auto remaining
+			= std::chrono::duration_cast<std::chrono::nanoseconds>( deadline - std::chrono::steady_clock::now() );
+		if( remaining.count() <= 0 ) {
+			return;
+		}
+		timespec ts{};
+		ts.tv_sec  = static_cast<time_t>( remaining.count() / 1'000'000'000 );
+		ts.tv_nsec = static_cast<long>( remaining.count() % 1'000'000'000 );
+		syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( &word ), FUTEX_WAIT, expected, &ts, nullptr, 0 );
+#else
+		(void)word;
+		(void)expected;
+		(void)deadline;
+		std::this_thread::yield();
+#endif
+	}
+
+	_detail_shm::Mapping _map;
+	const record_type*   _records = nullptr;
+	std::size_t          _mask    = 0;
+};
+
+} // namespace mba::units
@@ -0,0 +1,349 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mba::units {
+
+template<class X>
+struct RootResult {
+	X    root;
+	int  iterations;
+	bool converged;
+};
+
+template<class X, class Y>
+struct MinimumResult {
+	X    argument;
+	Y    value;
+	int  iterations;
+	bool converged;
+};
+
+namespace _detail_solve {
+
+constexpr double raw( double v ) noexcept
+{
+	return v;
+}
+
+template<class U>
+constexpr double raw( U v ) noexcept
+{
+	return v.value;
+}
+
+template<class F, class X>
+using result_t = std::invoke_result_t<F, X>;
+
+template<class F, class X>
+using indexed_result_t = std::invoke_result_t<F, std::size_t, X>;
+
+template<class X, class Y, class DY>
+constexpr void check_derivative() noexcept
+{
+	static_assert( std::is_same_v<DY, UDivide_t<Y, X>>, "derivative must have the dimension of f(x) / x" );
+}
+
+} // namespace _detail_solve
+
+/*
+ * Newton iteration for f(x) = 0, where df is the derivative of f.
+ *
+ * df must return UDivide_t<decltype(f(x)), X> (e.g. a USpeed for a function UTime -> UPos).
+ * Converged, once a step is smaller than tolerance.
+ */
+template<class X, class F, class DF>
+RootResult<X> newton( F f, DF df, X x0, X tolerance, int max_iterations = 50 )
+{
+	_detail_solve::check_derivative<X, _detail_solve::result_t<F, X>, _detail_solve::result_t<DF, X>>();
+
+	X x = x0;
+	for( int i = 1; i <= max_iterations; ++i ) {
+		const auto d = df( x );
+		if( _detail_solve::raw( d ) == 0.0 ) {
+			return {x, i, false};
+		}
+		const X step = f( x ) / d;
+		x -= step;
+		if( abs( step ) <= tolerance ) {
+			return {x, i, true};
+		}
+	}
+	return {x, max_iterations, false};
+}
+
+/*
+ * Bisection for f(x) = 0 in [lo, hi]. f(lo) and f(hi) must have different signs.
+ * Converged, once the bracket is smaller than tolerance.
+ */
+template<class X, class F>
+RootResult<X> bisect( F f, X lo, X hi, X tolerance, int max_iterations = 200 )
+{
+	double flo = _detail_solve::raw( f( lo ) );
+	if( flo == 0.0 ) {
+		return {lo, 0, true};
+	}
+	if( _detail_solve::raw( f( hi ) ) == 0.0 ) {
+		return {hi, 0, true};
+	}
+	if( ( flo < 0.0 ) == ( _detail_solve::raw( f( hi ) ) < 0.0 ) ) {
+		return {lo, 0, false};
+	}
+
+	for( int i = 1; i <= max_iterations; ++i ) {
+		const X      mid  = lo + ( hi - lo ) / 2.0;
+		const double fmid = _detail_solve::raw( f( mid ) );
+		if( fmid == 0.0 ) {
+			return {mid, i, true};
+		}
+		if( ( fmid < 0.0 ) == ( flo < 0.0 ) ) {
+			lo  = mid;
+			flo = fmid;
+		} else {
+			hi = mid;
+		}
+		if( abs( hi - lo ) <= tolerance ) {
+			return {lo + ( hi - lo ) / 2.0, i, true};
+		}
+	}
+	return {lo + ( hi - lo ) / 2.0, max_iterations, false};
+}
+
+/*
+ * Brent's method (inverse quadratic interpolation / secant / bisection) for f(x) = 0 in [lo, hi].
+ * f(lo) and f(hi) must have different signs.
+ */
+template<class X, class F>
+RootResult<X> brent( F f, X lo, X hi, X tolerance, int max_iterations = 100 )
+{
+	using _detail_solve::raw;
+
+	double a  = raw( lo );
+	double b  = raw( hi );
+	double fa = raw( f( lo ) );
+	double fb = raw( f( hi ) );
+	if( fa == 0.0 ) {
+		return {lo, 0, true};
+	}
+	if( fb == 0.0 ) {
+		return {hi, 0, true};
+	}
+	if( ( fa < 0.0 ) == ( fb < 0.0 ) ) {
+		return {lo, 0, false};
+	}
+
+	double c  = a;
+	double fc = fa;
+	double d  = b - a;
+	double e  = d;
+	for( int i = 1; i <= max_iterations; ++i ) {
+		if( ( fb < 0.0 ) == ( fc < 0.0 ) ) {
+			c  = a;
+			fc = fa;
+			d  = b - a;
+			e  = d;
+		}
+		if( std::abs( fc ) < std::abs( fb ) ) {
+			a  = b;
+			b  = c;
+			c  = a;
+			fa = fb;
+			fb = fc;
+			fc = fa;
+		}
+
+		const double tol = 0.5 * raw( tolerance );
+		const double m   = 0.5 * ( c - b );
+		if( std::abs( m ) <= tol || fb == 0.0 ) {
+			return {X{b}, i, true};
+		}
+
+		if( std::abs( e ) >= tol && std::abs( fa ) > std::abs( fb ) ) {
+			// interpolation
+			const double s = fb / fa;
+			double       p = 0.0;
+			double       q = 0.0;
+			if( a == c ) {
+				p = 2.0 * m * s;
+				q = 1.0 - s;
+			} else {
+				const double qa = fa / fc;
+				const double r  = fb / fc;
+				p               = s * ( 2.0 * m * qa * ( qa - r ) - ( b - a ) * ( r - 1.0 ) );
+				q               = ( qa - 1.0 ) * ( r - 1.0 ) * ( s - 1.0 );
+			}
+			if( p > 0.0 ) {
+				q = -q;
+			} else {
+				p = -p;
+			}
+			if( 2.0 * p < std::min( 3.0 * m * q - std::abs( tol * q ), std::abs( e * q ) ) ) {
+				e = d;
+				d = p / q;
+			} else {
+				d = m;
+				e = m;
+			}
+		} else {
+			d = m;
+			e = m;
+		}
+
+		a  = b;
+		fa = fb;
+		b += std::abs( d ) > tol ? d : ( m > 0.0 ? tol : -tol );
+		fb = raw( f( X{b} ) );
+	}
+	return {X{b}, max_iterations, false};
+}
+
+/*
+ * Golden section search for the minimum of a unimodal function on [lo, hi].
+ * Converged, once the bracket is smaller than tolerance.
+ */
+template<class X, class F>
+auto minimize_golden( F f, X lo, X hi, X tolerance, int max_iterations = 200 )
+	-> MinimumResult<X, _detail_solve::result_t<F, X>>
+{
+	constexpr double inv_phi = 0.6180339887498948482;
+
+	X    x1 = hi - ( hi - lo ) * inv_phi;
+	X    x2 = lo + ( hi - lo ) * inv_phi;
+	auto f1 = f( x1 );
+	auto f2 = f( x2 );
+	for( int i = 1; i <= max_iterations; ++i ) {
+		if( f1 < f2 ) {
+			hi = x2;
+			x2 = x1;
+			f2 = f1;
+			x1 = hi - ( hi - lo ) * inv_phi;
+			f1 = f( x1 );
+		} else {
+			lo = x1;
+			x1 = x2;
+			f1 = f2;
+			x2 = lo + ( hi - lo ) * inv_phi;
+			f2 = f( x2 );
+		}
+		if( abs( hi - lo ) <= tolerance ) {
+			const X x = lo + ( hi - lo ) / 2.0;
+			return {x, f( x ), i, true};
+		}
+	}
+	const X x = lo + ( hi - lo ) / 2.0;
+	return {x, f( x ), max_iterations, false};
+}
+
+// ######## batched solvers #############
+// Solve count independent problems f(i, x) = 0 in lockstep: every iteration evaluates all problems,
+// problems that already converged are masked out (their values are kept, not updated), so the
+// per-problem loop body is branch free and can be vectorized if f and df inline.
+// Return the number of converged problems, converged[i] (optional) receives the per problem result.
+
+template<class X, class F, class DF>
+std::size_t newton_batch( F           f,
+						  DF          df,
+						  X*          x,
+						  std::size_t count,
+						  X           tolerance,
+						  int         max_iterations = 50,
+						  bool*       converged      = nullptr )
+{
+	using Y = _detail_solve::indexed_result_t<F, X>;
+	_detail_solve::check_derivative<X, Y, _detail_solve::indexed_result_t<DF, X>>();
+
+	std::vector<std::uint8_t> active( count, 1 );
+	std::size_t               remaining = count;
+	const double              tol       = tolerance.value;
+
+	for( int it = 0; it < max_iterations && remaining > 0; ++it ) {
+		remaining = 0;
+		for( std::size_t i = 0; i < count; ++i ) {
+			const double d    = _detail_solve::raw( df( i, x[i] ) );
+			const double y    = _detail_solve::raw( f( i, x[i] ) );
+			const bool   ok   = d != 0.0;
+			const double step = ok ? y / d : 0.0;
+			const bool   run  = active[i] != 0 && ok;
+
+			x[i].value -= run ? step : 0.0;
+			// written as !( <= ), so a NaN step keeps the lane active (and unconverged)
+			active[i] = static_cast<std::uint8_t>( run && !( std::abs( step ) <= tol ) );
+			remaining += active[i];
+		}
+	}
+
+	std::size_t n_converged = 0;
+	for( std::size_t i = 0; i < count; ++i ) {
+		// lanes stopped with a zero derivative or a non finite value are not converged
+		const bool c = active[i] == 0 && std::isfinite( x[i].value ) && _detail_solve::raw( df( i, x[i] ) ) != 0.0;
+		n_converged += c;
+		if( converged ) {
+			converged[i] = c;
+		}
+	}
+	return n_converged;
+}
+
+// [lo[i], hi[i]] must bracket a root of f(i, x). root[i] receives the midpoint of the final bracket.
+template<class X, class F>
+std::size_t bisect_batch( F           f,
+						  const X*    lo,
+						  const X*    hi,
+						  X*          root,
+						  std::size_t count,
+						  X           tolerance,
+						  int         max_iterations = 200,
+						  bool*       converged      = nullptr )
+{
+	std::vector<double>       a( count );
+	std::vector<double>       b( count );
+	std::vector<std::uint8_t> neg_at_a( count );
+	std::vector<std::uint8_t> valid( count );
+	for( std::size_t i = 0; i < count; ++i ) {
+		const double fa = _detail_solve::raw( f( i, lo[i] ) );
+		const double fb = _detail_solve::raw( f( i, hi[i] ) );
+		// an exact root at one end collapses the bracket onto it
+		a[i]        = fb == 0.0 ? hi[i].value : lo[i].value;
+		b[i]        = fa == 0.0 ? lo[i].value : hi[i].value;
+		neg_at_a[i] = fa < 0.0;
+		valid[i]    = ( fa < 0.0 ) != ( fb < 0.0 ) || fa == 0.0 || fb == 0.0;
+	}
+
+	const double tol = tolerance.value;
+	for( int it = 0; it < max_iterations; ++it ) {
+		std::size_t remaining = 0;
+		for( std::size_t i = 0; i < count; ++i ) {
+			const bool   run  = std::abs( b[i] - a[i] ) > tol;
+			const double mid  = a[i] + ( b[i] - a[i] ) / 2.0;
+			const bool   same = ( _detail_solve::raw( f( i, X{mid} ) ) < 0.0 ) == ( neg_at_a[i] != 0 );
+
+			a[i] = run && same ? mid : a[i];
+			b[i] = run && !same ? mid : b[i];
+			remaining += run;
+		}
+		if( remaining == 0 ) {
+			break;
+		}
+	}
+
+	std::size_t n_converged = 0;
+	for( std::size_t i = 0; i < count; ++i ) {
+		root[i]      = X{a[i] + ( b[i] - a[i] ) / 2.0};
+		const bool c = valid[i] != 0 && std::abs( b[i] - a[i] ) <= tol;
+		n_converged += c;
+		if( converged ) {
+			converged[i] = c;
+		}
+	}
+	return n_converged;
+}
+
+} // namespace mba::units
@@ -0,0 +1,523 @@
+#pragma once
+
+#include "./units.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mba::units {
+
+// A point in N-dimensional space
+template<std::size_t N>
+using UPosVec = std::array<UPos, N>;
+
+// Result type of squared distances between two UPosVecs
+using UPosSquared = decltype( square( UPos{} ) );
+
+template<std::size_t N>
+constexpr UPosSquared distance_squared( const UPosVec<N>& l, const UPosVec<N>& r ) noexcept
+{
+	UPosSquared sum{};
+	for( std::size_t d = 0; d < N; ++d ) {
+		sum += square( l[d] - r[d] );
+	}
+	return sum;
+}
+
+// A single query result: index of the point (as passed to build/insert) and its squared distance to the query point
+struct SpatialHit {
+	std::size_t index;
+	UPosSquared distance_squared;
+};
+
+// index of a SpatialHit that doesn't refer to any point (see batch_nearest); its distance is infinite
+inline constexpr std::size_t no_spatial_hit = std::numeric_limits<std::size_t>::max();
+
+namespace _detail_spatial {
+
+template<std::size_t N>
+using CellKey = std::array<std::int64_t, N>;
+
+template<std::size_t N>
+struct CellKeyHash {
+	std::size_t operator()( const CellKey<N>& key ) const noexcept
+	{
+		// FNV-1a style mixing of the cell coordinates
+		std::uint64_t h = 0xcbf29ce484222325ull;
+		for( auto c : key ) {
+			h ^= static_cast<std::uint64_t>( c );
+			h *= 0x100000001b3ull;
+		}
+		return static_cast<std::size_t>( h );
+	}
+};
+
+// Calls fn( begin, end ) for chunks of [0, count) on up to thread_count threads (0 = hardware concurrency)
+template<class Fn>
+void parallel_chunks( std::size_t count, unsigned thread_count, Fn&& fn )
+{
+	if( thread_count == 0 ) {
+		thread_count = std::max( 1u, std::thread::hardware_concurrency() );
+	}
+	const std::size_t min_chunk = 256;
+	thread_count = static_cast<unsigned>( std::min<std::size_t>( thread_count, ( count + min_chunk - 1 ) / min_chunk ) );
+	if( thread_count <= 1 ) {
+		fn( std::size_t{0}, count );
+		return;
+	}
+
+	const std::size_t        chunk = ( count + thread_count - 1 ) / thread_count;
+	std::vector<std::thread> workers;
+	workers.reserve( thread_count - 1 );
+	for( unsigned t = 1; t < thread_count; ++t ) {
+		const std::size_t begin = std::min( count, t * chunk );
+		const std::size_t end   = std::min( count, begin + chunk );
+		workers.emplace_back( [&fn, begin, end] { fn( begin, end ); } );
+	}
+	fn( std::size_t{0}, std::min( count, chunk ) );
+	for( auto& w : workers ) {
+		w.join();
+	}
+}
+
+} // namespace _detail_spatial
+
+/*
+ * Uniform grid over points with UPos coordinates.
+ *
+ * Coordinates are stored as structure of arrays (one contiguous double array per axis),
+ * cells map to the indices of the points they contain.
+ * Best suited for many moving objects of similar extent and radius queries with a radius close to the cell size.
+ */
+template<std::size_t N>
+class UniformGrid {
+public:
+	// Throws std::invalid_argument, unless cell_size is positive and finite.
+	explicit UniformGrid( UPos cell_size )
+		: _inv_cell_size{1.0 / cell_size.value}
+	{
+		if( !( cell_size.value > 0.0 ) || !std::isfinite( cell_size.value ) ) {
+			throw std::invalid_argument( "UniformGrid: cell size must be positive and finite" );
+		}
+	}
+
+	// Replaces all content of the grid. Point i gets index i.
+	void build( const UPosVec<N>* points, std::size_t count )
+	{
+		_cells.clear();
+		for( auto& c : _coords ) {
+			c.resize( count );
+		}
+		_cell_of.resize( count );
+
+		// transpose into SoA first, so key computation below is a tight loop per axis
+		for( std::size_t i = 0; i < count; ++i ) {
+			for( std::size_t d = 0; d < N; ++d ) {
+				_coords[d][i] = points[i][d].value;
+			}
+		}
+
+		std::vector<std::pair<_detail_spatial::CellKey<N>, std::size_t>> keyed( count );
+		for( std::size_t d = 0; d < N; ++d ) {
+			const double* c = _coords[d].data();
+			for( std::size_t i = 0; i < count; ++i ) {
+				keyed[i].first[d] = _to_cell( c[i] );
+			}
+		}
+		for( std::size_t i = 0; i < count; ++i ) {
+			keyed[i].second = i;
+		}
+
+		// sort by cell, so each cell's index list is filled in one go
+		std::sort( keyed.begin(), keyed.end() );
+		for( std::size_t i = 0; i < count; ) {
+			auto&       cell = _cells[keyed[i].first];
+			std::size_t j    = i;
+			while( j < count && keyed[j].first == keyed[i].first ) {
+				++j;
+			}
+			cell.reserve( cell.size() + ( j - i ) );
+			for( ; i < j; ++i ) {
+				cell.push_back( keyed[i].second );
+				_cell_of[keyed[i].second] = keyed[i].first;
+			}
+		}
+	}
+
+	void build( const std::vector<UPosVec<N>>& points ) { build( points.data(), points.size() ); }
+
+	// Adds a single point and returns its index
+	std::size_t insert( const UPosVec<N>& p )
+	{
+		const std::size_t idx = size();
+		for( std::size_t d = 0; d < N; ++d ) {
+			_coords[d].push_back( p[d].value );
+		}
+		_cell_of.push_back( _key_of( p ) );
+		_cells[_cell_of.back()].push_back( idx );
+		return idx;
+	}
+
+	// Moves the point with index idx. Only touches the cell map if the point changes its cell.
+	void move( std::size_t idx, const UPosVec<N>& p )
+	{
+		for( std::size_t d = 0; d < N; ++d ) {
+			_coords[d][idx] = p[d].value;
+		}
+		const auto key = _key_of( p );
+		if( key == _cell_of[idx] ) {
+			return;
+		}
+
+		auto  old_it = _cells.find( _cell_of[idx] );
+		auto& old    = old_it->second;
+		old.erase( std::find( old.begin(), old.end(), idx ) );
+		if( old.empty() ) {
+			_cells.erase( old_it );
+		}
+		_cells[key].push_back( idx );
+		_cell_of[idx] = key;
+	}
+
+	std::size_t size() const noexcept { return _cell_of.size(); }
+
+	UPosVec<N> position( std::size_t idx ) const noexcept
+	{
+		UPosVec<N> p;
+		for( std::size_t d = 0; d < N; ++d ) {
+			p[d] = UPos{_coords[d][idx]};
+		}
+		return p;
+	}
+
+	// Appends all points within radius of center to out (unordered)
+	void radius_query( const UPosVec<N>& center, UPos radius, std::vector<SpatialHit>& out ) const
+	{
+		if( !( radius.value >= 0.0 ) ) {
+			return;
+		}
+		const double r2 = radius.value * radius.value;
+
+		_detail_spatial::CellKey<N> lo;
+		_detail_spatial::CellKey<N> hi;
+		double                      box_cells = 1.0;
+		for( std::size_t d = 0; d < N; ++d ) {
+			lo[d] = _to_cell( center[d].value - radius.value );
+			hi[d] = _to_cell( center[d].value + radius.value );
+			box_cells *= static_cast<double>( hi[d] ) - static_cast<double>( lo[d] ) + 1.0;
+		}
+
+		// A large radius on a sparse grid covers more cells than are occupied: test the occupied ones instead
+		if( box_cells > static_cast<double>( _cells.size() ) ) {
+			for( const auto& [key, indices] : _cells ) {
+				bool inside = true;
+				for( std::size_t d = 0; d < N; ++d ) {
+					inside = inside && key[d] >= lo[d] && key[d] <= hi[d];
+				}
+				if( inside ) {
+					_collect( indices, center, r2, out );
+				}
+			}
+			return;
+		}
+
+		// iterate over all cells in [lo, hi] (odometer style)
+		_detail_spatial::CellKey<N> key = lo;
+		while( true ) {
+			auto it = _cells.find( key );
+			if( it != _cells.end() ) {
+				_collect( it->second, center, r2, out );
+			}
+
+			std::size_t d = 0;
+			for( ; d < N; ++d ) {
+				if( key[d] < hi[d] ) {
+					++key[d];
+					break;
+				}
+				key[d] = lo[d];
+			}
+			if( d == N ) {
+				break;
+			}
+		}
+	}
+
+	std::vector<SpatialHit> radius_query( const UPosVec<N>& center, UPos radius ) const
+	{
+		std::vector<SpatialHit> out;
+		radius_query( center, radius, out );
+		return out;
+	}
+
+private:
+	// cell coordinates are clamped to +-2^62, so the conversion below is defined for every input
+	// (NaN maps to cell 0) and the box size in radius_query can't overflow
+	static constexpr double _max_cell = 4611686018427387904.0;
+
+	std::int64_t _to_cell( double c ) const noexcept
+	{
+		const double cell = std::floor( c * _inv_cell_size );
+		if( std::isnan( cell ) ) {
+			return 0;
+		}
+		return static_cast<std::int64_t>( std::clamp( cell, -_max_cell, _max_cell ) );
+	}
+
+	void _collect( const std::vector<std::size_t>& indices,
+				   const UPosVec<N>&               center,
+				   double                          r2,
+				   std::vector<SpatialHit>&        out ) const
+	{
+		for( auto idx : indices ) {
+			double dist2 = 0.0;
+			for( std::size_t d = 0; d < N; ++d ) {
+				const double diff = _coords[d][idx] - center[d].value;
+				dist2 += diff * diff;
+			}
+			if( dist2 <= r2 ) {
+				out.push_back( SpatialHit{idx, UPosSquared{dist2}} );
+			}
+		}
+	}
+
+	_detail_spatial::CellKey<N> _key_of( const UPosVec<N>& p ) const noexcept
+	{
+		_detail_spatial::CellKey<N> key;
+		for( std::size_t d = 0; d < N; ++d ) {
+			key[d] = _to_cell( p[d].value );
+		}
+		return key;
+	}
+
+	double                                   _inv_cell_size;
+	std::array<std::vector<double>, N>       _coords;
+	std::vector<_detail_spatial::CellKey<N>> _cell_of;
+	std::unordered_map<_detail_spatial::CellKey<N>, std::vector<std::size_t>, _detail_spatial::CellKeyHash<N>> _cells;
+};
+
+/*
+ * Static k-d tree over points with UPos coordinates.
+ *
+ * The tree is implicit: points are reordered such that for every range [lo, hi) the median element
+ * splits the range along axis (depth % N). Small ranges are scanned linearly.
+ * Moving points require a rebuild - use UniformGrid for highly dynamic data.
+ */
+template<std::size_t N>
+class KdTree {
+public:
+	KdTree() = default;
+	KdTree( const UPosVec<N>* points, std::size_t count ) { build( points, count ); }
+	explicit KdTree( const std::vector<UPosVec<N>>& points ) { build( points.data(), points.size() ); }
+
+	// Replaces all content of the tree. Point i gets index i.
+	void build( const UPosVec<N>* points, std::size_t count )
+	{
+		std::vector<RawPoint> raw( count );
+		_index.resize( count );
+		for( std::size_t i = 0; i < count; ++i ) {
+			raw[i]    = _raw( points[i] );
+			_index[i] = i;
+		}
+		_build( raw, 0, count, 0 );
+
+		// gather once, so queries walk contiguous memory in tree order
+		_points.resize( count );
+		for( std::size_t i = 0; i < count; ++i ) {
+			_points[i] = raw[_index[i]];
+		}
+	}
+
+	std::size_t size() const noexcept { return _points.size(); }
+
+	std::optional<SpatialHit> nearest( const UPosVec<N>& query ) const
+	{
+		if( _points.empty() ) {
+			return std::nullopt;
+		}
+		const auto  q    = _raw( query );
+		std::size_t best = 0;
+		double      bd2  = std::numeric_limits<double>::infinity();
+		_nearest( 0, _points.size(), 0, q, best, bd2 );
+		return SpatialHit{_index[best], UPosSquared{bd2}};
+	}
+
+	// Appends all points within radius of center to out (unordered)
+	void radius_query( const UPosVec<N>& center, UPos radius, std::vector<SpatialHit>& out ) const
+	{
+		_radius( 0, _points.size(), 0, _raw( center ), radius.value * radius.value, out );
+	}
+
+	std::vector<SpatialHit> radius_query( const UPosVec<N>& center, UPos radius ) const
+	{
+		std::vector<SpatialHit> out;
+		radius_query( center, radius, out );
+		return out;
+	}
+
+private:
+	using RawPoint = std::array<double, N>;
+
+	static constexpr std::size_t leaf_size = 8;
+
+	static RawPoint _raw( const UPosVec<N>& p ) noexcept
+	{
+		RawPoint r;
+		for( std::size_t d = 0; d < N; ++d ) {
+			r[d] = p[d].value;
+		}
+		return r;
+	}
+
+	static double _dist2( const RawPoint& l, const RawPoint& r ) noexcept
+	{
+		double sum = 0.0;
+		for( std::size_t d = 0; d < N; ++d ) {
+			const double diff = l[d] - r[d];
+			sum += diff * diff;
+		}
+		return sum;
+	}
+
+	void _build( const std::vector<RawPoint>& raw, std::size_t lo, std::size_t hi, std::size_t depth )
+	{
+		if( hi - lo <= leaf_size ) {
+			return;
+		}
+		const std::size_t axis = depth % N;
+		const std::size_t mid  = lo + ( hi - lo ) / 2;
+
+		std::nth_element( _index.begin() + lo,
+						  _index.begin() + mid,
+						  _index.begin() + hi,
+						  [&]( std::size_t l, std::size_t r ) { return raw[l][axis] < raw[r][axis]; } );
+
+		_build( raw, lo, mid, depth + 1 );
+		_build( raw, mid + 1, hi, depth + 1 );
+	}
+
+	void _nearest(
+		std::size_t lo, std::size_t hi, std::size_t depth, const RawPoint& q, std::size_t& best, double& bd2 ) const
+	{
+		if( hi - lo <= leaf_size ) {
+			for( std::size_t i = lo; i < hi; ++i ) {
+				const double d2 = _dist2( _points[i], q );
+				if( d2 < bd2 ) {
+					bd2  = d2;
+					best = i;
+				}
+			}
+			return;
+		}
+		const std::size_t axis = depth % N;
+		const std::size_t mid  = lo + ( hi - lo ) / 2;
+
+		const double d2 = _dist2( _points[mid], q );
+		if( d2 < bd2 ) {
+			bd2  = d2;
+			best = mid;
+		}
+
+		const double diff       = q[axis] - _points[mid][axis];
+		const bool   left_first = diff < 0.0;
+		if( left_first ) {
+			_nearest( lo, mid, depth + 1, q, best, bd2 );
+		} else {
+			_nearest( mid + 1, hi, depth + 1, q, best, bd2 );
+		}
+		if( diff * diff < bd2 ) {
+			if( left_first ) {
+				_nearest( mid + 1, hi, depth + 1, q, best, bd2 );
+			} else {
+				_nearest( lo, mid, depth + 1, q, best, bd2 );
+			}
+		}
+	}
+
+	void _radius( std::size_t             lo,
+				  std::size_t             hi,
+				  std::size_t             depth,
+				  const RawPoint&         q,
+				  double                  r2,
+				  std::vector<SpatialHit>& out ) const
+	{
+		if( hi - lo <= leaf_size ) {
+			for( std::size_t i = lo; i < hi; ++i ) {
+				const double d2 = _dist2( _points[i], q );
+				if( d2 <= r2 ) {
+					out.push_back( SpatialHit{_index[i], UPosSquared{d2}} );
+				}
+			}
+			return;
+		}
+		const std::size_t axis = depth % N;
+		const std::size_t mid  = lo + ( hi - lo ) / 2;
+
+		const double d2 = _dist2( _points[mid], q );
+		if( d2 <= r2 ) {
+			out.push_back( SpatialHit{_index[mid], UPosSquared{d2}} );
+		}
+
+		const double diff = q[axis] - _points[mid][axis];
+		if( diff <= 0.0 || diff * diff <= r2 ) {
+			_radius( lo, mid, depth + 1, q, r2, out );
+		}
+		if( diff >= 0.0 || diff * diff <= r2 ) {
+			_radius( mid + 1, hi, depth + 1, q, r2, out );
+		}
+	}
+
+	std::vector<RawPoint>    _points;
+	std::vector<std::size_t> _index;
+};
+
+// ######## batch queries #############
+// Queries are independent and read only, so they are split into chunks and processed on up to thread_count
+// threads (0 = std::thread::hardware_concurrency()).
+
+// out[i] receives the nearest point to queries[i]. If the tree is empty, that is
+// SpatialHit{no_spatial_hit, infinite distance}.
+template<std::size_t N>
+void batch_nearest( const KdTree<N>&  tree,
+					const UPosVec<N>* queries,
+					std::size_t       count,
+					SpatialHit*       out,
+					unsigned          thread_count = 0 )
+{
+	_detail_spatial::parallel_chunks( count, thread_count, [&]( std::size_t begin, std::size_t end ) {
+		for( std::size_t i = begin; i < end; ++i ) {
+			out[i] = tree.nearest( queries[i] ).value_or(
+				SpatialHit{no_spatial_hit, UPosSquared{std::numeric_limits<double>::infinity()}} );
+		}
+	} );
+}
+
+// out is resized to count; out[i] receives the hits of queries[i]
+template<class SpatialIndex, std::size_t N>
+void batch_radius_query( const SpatialIndex&                   index,
+						 const UPosVec<N>*                     queries,
+						 std::size_t                           count,
+						 UPos                                  radius,
+						 std::vector<std::vector<SpatialHit>>& out,
+						 unsigned                              thread_count = 0 )
+{
+	out.resize( count );
+	_detail_spatial::parallel_chunks( count, thread_count, [&]( std::size_t begin, std::size_t end ) {
+		for( std::size_t i = begin; i < end; ++i ) {
+			out[i].clear();
+			index.radius_query( queries[i], radius, out[i] );
+		}
+	} );
+}
+
+} // namespace mba::units
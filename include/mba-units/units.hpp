@@ -2,6 +2,8 @@
 
 #include <cmath> //sqrt, cos, sin, tan ...
 
+#include "./checked.hpp"
+
 namespace mba::units {
 
 // For initializing a Unit where you are too lazy to specify the exact type
@@ -9,6 +11,9 @@ struct UGen {
 	double value;
 };
 
+// the unit types, their operators and everything else using MBA_UNITS_CHECKED (see checked.hpp)
+MBA_UNITS_CHECK_MODE_NAMESPACE_BEGIN
+
 namespace detail {
 
 // CRTP implementing common functionality for all unit types
@@ -26,32 +31,32 @@ struct CommonUnitBase {
 	// #### compund assignment operators ####
 	// offset
 	// clang-format off
-	constexpr T& operator+=( T other ) noexcept { value += other.value; return *static_cast<T*>( this ); }
-	constexpr T& operator-=( T other ) noexcept { value -= other.value;	return *static_cast<T*>( this ); }
+	constexpr T& operator+=( T other ) noexcept { value = MBA_UNITS_CHECKED( T, add, value + other.value ); return *static_cast<T*>( this ); }
+	constexpr T& operator-=( T other ) noexcept { value = MBA_UNITS_CHECKED( T, subtract, value - other.value ); return *static_cast<T*>( this ); }
 
 	// scaling
-	constexpr T& operator*=( double other )	noexcept { value *= other; return *static_cast<T*>( this ); }
-	constexpr T& operator/=( double other )	noexcept { value /= other; return *static_cast<T*>( this ); }
+	constexpr T& operator*=( double other )	noexcept { value = MBA_UNITS_CHECKED( T, multiply, value * other ); return *static_cast<T*>( this ); }
+	constexpr T& operator/=( double other )	noexcept { value = MBA_UNITS_CHECKED( T, divide, value / other ); return *static_cast<T*>( this ); }
 	// clang-format on
 
 	// #### biniary operators ####
-	friend constexpr auto operator+( T l, T r ) noexcept -> T { return T{l.value + r.value}; }
-	friend constexpr auto operator-( T l, T r ) noexcept -> T { return T{l.value - r.value}; }
+	friend constexpr auto operator+( T l, T r ) noexcept -> T { return T{MBA_UNITS_CHECKED( T, add, l.value + r.value )}; }
+	friend constexpr auto operator-( T l, T r ) noexcept -> T { return T{MBA_UNITS_CHECKED( T, subtract, l.value - r.value )}; }
 
 	friend constexpr auto operator-( T l ) noexcept -> T { return T{-l.value}; }
 	friend constexpr auto operator+( T l ) noexcept -> T { return l; }
 
-	friend constexpr auto operator*( T l, double r ) noexcept -> T { return T{l.value * r}; }
-	friend constexpr auto operator*( double l, T r ) noexcept -> T { return T{l * r.value}; }
+	friend constexpr auto operator*( T l, double r ) noexcept -> T { return T{MBA_UNITS_CHECKED( T, multiply, l.value * r )}; }
+	friend constexpr auto operator*( double l, T r ) noexcept -> T { return T{MBA_UNITS_CHECKED( T, multiply, l * r.value )}; }
 
 	// scaling
-	friend constexpr auto operator/( T l, double r ) noexcept -> T { return T{l.value / r}; }
+	friend constexpr auto operator/( T l, double r ) noexcept -> T { return T{MBA_UNITS_CHECKED( T, divide, l.value / r )}; }
 	// NOTE: double/Unit may not always make sense, so not implemented here
 
 	friend constexpr auto abs( T l ) noexcept { return T( l.value < 0.0 ? -l.value : l.value ); }
 	friend constexpr auto max( T l, T r ) noexcept { return T( l.value > r.value ? l.value : r.value ); }
 	friend constexpr auto min( T l, T r ) noexcept { return T( l.value < r.value ? l.value : r.value ); }
-	friend inline auto    fmod( T l, T r ) noexcept { return T( std::fmod( l.value, r.value ) ); }
+	friend inline auto    fmod( T l, T r ) noexcept { return T( MBA_UNITS_CHECKED( T, fmod, std::fmod( l.value, r.value ) ) ); }
 
 	// comparison operators
 	friend constexpr bool operator<( T l, T r ) noexcept { return {l.value < r.value}; }
@@ -97,7 +102,11 @@ struct UAngle : detail::CommonUnitBase<UAngle> {
 		: Base( v.value ){};
 	constexpr operator Unit<0, 0, 0>() const noexcept { return value; }
 
-	friend constexpr double operator/( UAngle l, UAngle r ) noexcept { return l.value / r.value; }
+	friend constexpr double operator/( UAngle l, UAngle r ) noexcept
+	{
+		using R [[maybe_unused]] = Unit<0, 0, 0>; // only named by MBA_UNITS_CHECKED in the checked modes
+		return MBA_UNITS_CHECKED( R, divide, l.value / r.value );
+	}
 };
 
 //##### Operator overloads that involve different types #####
@@ -105,19 +114,22 @@ struct UAngle : detail::CommonUnitBase<UAngle> {
 template<int k1, int m1, int s1, int k2, int m2, int s2>
 constexpr auto operator*( Unit<k1, m1, s1> l, Unit<k2, m2, s2> r ) noexcept -> Unit<k1 + k2, m1 + m2, s1 + s2>
 {
-	return Unit<k1 + k2, m1 + m2, s1 + s2>{l.value * r.value};
+	using R = Unit<k1 + k2, m1 + m2, s1 + s2>;
+	return R{MBA_UNITS_CHECKED( R, multiply, l.value * r.value )};
 };
 
 template<int k1, int m1, int s1, int k2, int m2, int s2>
 constexpr auto operator/( Unit<k1, m1, s1> l, Unit<k2, m2, s2> r ) noexcept -> Unit<k1 - k2, m1 - m2, s1 - s2>
 {
-	return Unit<k1 - k2, m1 - m2, s1 - s2>{l.value / r.value};
+	using R = Unit<k1 - k2, m1 - m2, s1 - s2>;
+	return R{MBA_UNITS_CHECKED( R, divide, l.value / r.value )};
 };
 
 template<int k2, int m2, int s2>
 constexpr auto operator/( double l, Unit<k2, m2, s2> r ) noexcept -> Unit<0 - k2, 0 - m2, 0 - s2>
 {
-	return Unit<-k2, -m2, -s2>{l / r.value};
+	using R = Unit<-k2, -m2, -s2>;
+	return R{MBA_UNITS_CHECKED( R, divide, l / r.value )};
 };
 
 // ######## more complex mathematical operations #############
@@ -132,13 +144,15 @@ template<int k, int m, int s>
 constexpr auto sqrt( Unit<k, m, s> l ) noexcept -> Unit<( k / 2 ), ( m / 2 ), ( s / 2 )>
 {
 	static_assert( canTakeSqrt( Unit<k, m, s>{} ), "Base units are not a power of 2" );
-	return Unit<( k / 2 ), ( m / 2 ), ( s / 2 )>( std::sqrt( l.value ) );
+	using R = Unit<( k / 2 ), ( m / 2 ), ( s / 2 )>;
+	return R( MBA_UNITS_CHECKED( R, sqrt, std::sqrt( l.value ) ) );
 }
 
 template<int k, int m, int s>
 constexpr auto square( Unit<k, m, s> l ) noexcept -> Unit<( k * 2 ), ( m * 2 ), ( s * 2 )>
 {
-	return Unit<( k * 2 ), ( m * 2 ), ( s * 2 )>( l.value * l.value );
+	using R = Unit<( k * 2 ), ( m * 2 ), ( s * 2 )>;
+	return R( MBA_UNITS_CHECKED( R, multiply, l.value * l.value ) );
 }
 
 inline double cos( UAngle l ) noexcept
@@ -158,9 +172,11 @@ inline double tan( UAngle l ) noexcept
 
 inline UAngle atan2( double Y, double X ) noexcept
 {
-	return UAngle{std::atan2( Y, X )};
+	return UAngle{MBA_UNITS_CHECKED( UAngle, atan2, std::atan2( Y, X ) )};
 }
 
+MBA_UNITS_CHECK_MODE_NAMESPACE_END
+
 // helper types to get the result type of a mathematical operation on units
 namespace _unit_impl {
 
@@ -222,6 +238,15 @@ struct UMultiply<double, UAngle> {
 	using type = UAngle;
 };
 
+template<class U1, int N>
+struct UPower {
+};
+
+template<int k, int m, int s, int N>
+struct UPower<Unit<k, m, s>, N> {
+	using type = Unit<k * N, m * N, s * N>;
+};
+
 } // namespace _unit_impl
 
 template<class U1, class U2>
@@ -233,14 +258,39 @@ using UMultiply_t = typename _unit_impl::UMultiply<U1, U2>::type;
 template<class U1>
 using UInverse_t = UDivide_t<Unit<0, 0, 0>, U1>;
 
+// U^N for integral N (e.g. UPower_t<UTime, -2> == Unit<0, 0, -2>)
+template<class U1, int N>
+using UPower_t = typename _unit_impl::UPower<U1, N>::type;
+
+// exponents of the base units of a unit type
+template<class U>
+struct UDimension {
+};
+
+template<int k, int m, int s>
+struct UDimension<Unit<k, m, s>> {
+	static constexpr int  kilogram = k;
+	static constexpr int  meter    = m;
+	static constexpr int  second   = s;
+	static constexpr bool is_angle = false;
+};
+
+template<>
+struct UDimension<UAngle> {
+	static constexpr int  kilogram = 0;
+	static constexpr int  meter    = 0;
+	static constexpr int  second   = 0;
+	static constexpr bool is_angle = true;
+};
+
 //##### Operator overload for Angle #####
 
 namespace _detail_angle {
 
-constexpr long double pi_internal    = 3.141592653589793238462643383279502884L;
-constexpr long double rad_per_degree = pi_internal / 180.0L;
-constexpr double      pi             = static_cast<double>( pi_internal );
-constexpr double      two_pi         = static_cast<double>( 2 * pi_internal );
+inline constexpr long double pi_internal    = 3.141592653589793238462643383279502884L;
+inline constexpr long double rad_per_degree = pi_internal / 180.0L;
+inline constexpr double      pi             = static_cast<double>( pi_internal );
+inline constexpr double      two_pi         = static_cast<double>( 2 * pi_internal );
 
 constexpr double normNegPiPi( double angle ) noexcept
 {
@@ -272,7 +322,7 @@ constexpr double normNeg2Pi2Pi( double angle ) noexcept
 
 } // namespace _detail_angle
 
-constexpr UAngle pi = UAngle{(double)_detail_angle::pi_internal};
+inline constexpr UAngle pi = UAngle{(double)_detail_angle::pi_internal};
 
 /*
  * normalize angle to interval [-pi, pi]
@@ -302,6 +352,7 @@ using UTime   = Unit<0, 0, 1>;
 using UHerz   = Unit<0, 0, -1>;
 using USpeed  = Unit<0, 1, -1>;
 using UAccel  = Unit<0, 1, -2>;
+using UJerk   = Unit<0, 1, -3>;
 using UForce  = Unit<1, 1, -2>;
 using UTorque = Unit<1, 2, -2>;
 using ::mba::units::UGen;
@@ -329,7 +380,7 @@ constexpr UAngle	operator""_deg	( long double t ) noexcept { return UAngle{ (dou
 
 inline UAngle atan2( UPos Y, UPos X )
 {
-	return UAngle{std::atan2( Y.value, X.value )};
+	return UAngle{MBA_UNITS_CHECKED( UAngle, atan2, std::atan2( Y.value, X.value ) )};
 }
 
 } // namespace mba::units
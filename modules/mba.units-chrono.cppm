@@ -0,0 +1,14 @@
+// Interoperability with std::chrono (interop_chrono.hpp)
+module;
+
+#include <chrono>
+
+export module mba.units:chrono;
+
+export import :core;
+
+// the unit types are provided by :core - don't include units.hpp a second time
+#define MBA_UNITS_MODULE_CORE_IMPORTED
+export {
+#include <mba-units/interop_chrono.hpp>
+}
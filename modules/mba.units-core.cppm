@@ -0,0 +1,14 @@
+// Internal partition: exports everything declared in units.hpp
+module;
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+export module mba.units:core;
+
+export {
+#include <mba-units/units.hpp>
+}
@@ -0,0 +1,14 @@
+// Formatting support (fmt.hpp)
+module;
+
+#include <ostream>
+
+export module mba.units:fmt;
+
+export import :core;
+
+// the unit types are provided by :core - don't include units.hpp a second time
+#define MBA_UNITS_MODULE_CORE_IMPORTED
+export {
+#include <mba-units/fmt.hpp>
+}
@@ -0,0 +1,18 @@
+// Module interface of the units library
+//
+//	import mba.units;
+//
+// is equivalent to including units.hpp, fmt.hpp and interop_chrono.hpp.
+module;
+
+// not needed by the interface itself, but works around an internal compiler error
+// in GCC 12 when re-exporting partitions that use these headers
+#include <chrono>
+#include <cmath>
+#include <ostream>
+
+export module mba.units;
+
+export import :core;
+export import :fmt;
+export import :chrono;
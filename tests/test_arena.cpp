@@ -0,0 +1,98 @@
+#include <mba-units/arena.hpp>
+
+#include "test_common.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+bool is_aligned( const void* p, std::size_t alignment )
+{
+	return reinterpret_cast<std::uintptr_t>( p ) % alignment == 0;
+}
+
+void check_alignment()
+{
+	units::FrameArena arena( 1024 );
+	for( std::size_t bytes : {1u, 3u, 8u, 100u, 4000u} ) {
+		check( is_aligned( arena.allocate( bytes ), units::FrameArena::simd_alignment ), "simd alignment" );
+	}
+	check( is_aligned( arena.allocate( 8, 256 ), 256 ), "over alignment" );
+}
+
+void check_reset()
+{
+	units::FrameArena arena( 256 );
+
+	// overflow into further blocks
+	for( int i = 0; i < 20; ++i ) {
+		arena.allocate( 200 );
+	}
+	check( arena.block_count() > 1, "grows" );
+
+	// after reset everything fits into a single block, so the next frame does not allocate
+	arena.reset();
+	check( arena.block_count() == 1, "merged on reset" );
+	const auto capacity = arena.capacity();
+	for( int i = 0; i < 20; ++i ) {
+		arena.allocate( 200 );
+	}
+	check( arena.block_count() == 1 && arena.capacity() == capacity, "no growth after warm up" );
+
+	units::FrameArena single( 256 );
+	void*             a = single.allocate( 16 );
+	single.reset();
+	check( single.allocate( 16 ) == a, "memory is reused" );
+}
+
+void check_containers()
+{
+	units::FrameArena arena;
+
+	units::ArenaVector<units::UPos> positions{units::ArenaAllocator<units::UPos>( arena )};
+	for( int i = 0; i < 1000; ++i ) {
+		positions.push_back( units::UPos{static_cast<double>( i )} );
+	}
+	check( positions[999] == 999.0_m && is_aligned( positions.data(), 64 ), "ArenaVector" );
+
+	auto speeds = units::make_arena_array<units::USpeed>( arena, 100 );
+	check( speeds.size() == 100 && speeds[42] == 0.0_mps && is_aligned( speeds.data(), 64 ), "make_arena_array" );
+
+	units::ArenaResource              resource( arena );
+	std::pmr::vector<units::UAccel> accels( &resource );
+	accels.resize( 50, 1.0_mps2 );
+	check( accels[49] == 1.0_mps2 && is_aligned( accels.data(), 64 ), "pmr adapter" );
+
+	units::ArenaResource other( arena );
+	check( resource.is_equal( other ), "resources on the same arena compare equal" );
+}
+
+void check_poisoning()
+{
+	units::FrameArena arena;
+	auto              values = units::make_arena_array<units::UPos>( arena, 4 );
+	values[0]                = 1.0_m;
+	arena.reset();
+
+	// stale reads after reset hit the poison pattern (intentionally reading released memory here)
+	const bool poisoned = std::isnan( values[0].value );
+	check( poisoned == ( MBA_UNITS_ARENA_POISON != 0 ), "poisoning" );
+}
+
+} // namespace
+
+int main()
+{
+	check_alignment();
+	check_reset();
+	check_containers();
+	check_poisoning();
+	return failures == 0 ? 0 : 1;
+}
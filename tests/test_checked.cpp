@@ -0,0 +1,132 @@
+// Built with MBA_UNITS_CHECK_MODE=1 and with MBA_UNITS_CHECK_MODE=2, MBA_UNITS_CHECK_SAMPLE_RATE=4
+#include <mba-units/units.hpp>
+
+#include "test_common.hpp"
+
+#include <limits>
+#include <thread>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+// constant evaluation is unaffected
+static_assert( 1.0_m + 2.0_m == 3.0_m );
+static_assert( ( 6.0_m / 2.0_s ) == 3.0_mps );
+
+// volatile, so the compiler doesn't see through the values
+volatile double zero = 0.0;
+volatile double huge = std::numeric_limits<double>::max();
+
+const units::CheckCounters& counters()
+{
+	return units::thread_check_counters();
+}
+
+#if MBA_UNITS_CHECK_MODE == 1
+
+void check_all()
+{
+	units::reset_thread_check_counters();
+
+	const units::UPos    p = 1.0_m + 2.0_m;
+	const units::USpeed  v = p / 2.0_s;
+	const units::UAccel  a = v / 1.0_s;
+	check( counters().checked == 3 && counters().events == 0, "finite results" );
+
+	const units::USpeed nan_v = units::sqrt( units::Unit<0, 2, -2>{-1.0} );
+	check( counters().events == 1 && counters().nan[static_cast<int>( units::CheckedOp::sqrt )] == 1, "sqrt nan" );
+	check( counters().last.op == units::CheckedOp::sqrt && counters().last.meter == 1 && counters().last.second == -1,
+		   "sqrt dimension" );
+
+	// NaN propagates: every following operation is flagged
+	const units::UPos nan_p = nan_v * 1.0_s;
+	check( counters().events == 2 && counters().last.op == units::CheckedOp::multiply, "nan propagation" );
+
+	const units::UForce inf_f = units::UForce{huge} * 2.0;
+	check( counters().inf[static_cast<int>( units::CheckedOp::multiply )] == 1, "overflow" );
+	check( counters().last.kilogram == 1 && counters().last.meter == 1 && counters().last.second == -2
+			   && !counters().last.is_angle,
+		   "overflow dimension" );
+
+	const units::UTime inf_t = 1.0_s / zero;
+	check( counters().inf[static_cast<int>( units::CheckedOp::divide )] == 1, "division by zero" );
+
+	const units::UPos m = fmod( 1.0_m, units::UPos{zero} );
+	check( counters().nan[static_cast<int>( units::CheckedOp::fmod )] == 1, "fmod" );
+
+	const units::UAngle ang = units::atan2( units::UPos{std::numeric_limits<double>::quiet_NaN()}, 1.0_m );
+	check( counters().last.op == units::CheckedOp::atan2 && counters().last.is_angle, "atan2" );
+
+	units::UPos acc = 1.0_m;
+	acc += units::UPos{huge};
+	acc += units::UPos{huge};
+	check( counters().inf[static_cast<int>( units::CheckedOp::add )] == 1, "compound add" );
+
+	check( units::check_event_total( units::CheckedOp::add ) == 1, "global total" );
+
+	// counters are per thread
+	std::uint64_t other_events = 1;
+	std::thread( [&] {
+		const units::UPos x = units::UPos{huge} * 4.0;
+		(void)x;
+		other_events = units::thread_check_counters().events;
+	} ).join();
+	check( other_events == 1, "other thread" );
+	check( counters().inf[static_cast<int>( units::CheckedOp::multiply )] == 1, "other thread doesn't touch ours" );
+	check( units::check_event_total( units::CheckedOp::multiply ) == 3, "global multiply total" );
+
+	const units::Unit<0, 2, 0> sq = units::square( units::UPos{1e200} );
+	check( counters().inf[static_cast<int>( units::CheckedOp::multiply )] == 2 && counters().last.meter == 2,
+		   "square overflow" );
+
+	const double ratio = units::UAngle{zero} / units::UAngle{zero};
+	check( counters().nan[static_cast<int>( units::CheckedOp::divide )] == 1 && counters().last.meter == 0
+			   && !counters().last.is_angle,
+		   "angle ratio" );
+
+	(void)sq;
+	(void)ratio;
+	(void)a;
+	(void)nan_p;
+	(void)inf_f;
+	(void)inf_t;
+	(void)m;
+	(void)ang;
+}
+
+#else
+
+void check_all()
+{
+	units::reset_thread_check_counters();
+	units::_detail_checked::sample_tick() = 0;
+
+	units::UPos p = 0.0_m;
+	for( int i = 0; i < 400; ++i ) {
+		p += 1.0_m;
+	}
+	check( counters().checked == 100 && counters().events == 0, "sampling rate" );
+
+	// only every 4th non finite result is seen
+	int flagged = 0;
+	for( int i = 0; i < 8; ++i ) {
+		const auto before = counters().events;
+		const units::UTime t = 1.0_s / zero;
+		(void)t;
+		flagged += counters().events != before;
+	}
+	check( flagged == 2 && counters().last.second == 1, "sampled events" );
+}
+
+#endif
+
+} // namespace
+
+int main()
+{
+	check_all();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Minimal check helpers shared by the test executables
+
+#include <cmath>
+#include <cstdio>
+
+namespace mba::test {
+
+inline int failures = 0;
+
+inline void check( bool cond, const char* what )
+{
+	if( !cond ) {
+		std::printf( "FAILED: %s\n", what );
+		++failures;
+	}
+}
+
+// relative comparison, scaled by the magnitude of the operands
+inline bool close( double l, double r, double tol = 1e-9 )
+{
+	return std::abs( l - r ) <= tol * ( 1.0 + std::abs( l ) + std::abs( r ) );
+}
+
+} // namespace mba::test
@@ -0,0 +1,120 @@
+#include <mba-units/fft.hpp>
+
+#include "test_common.hpp"
+
+#include <cmath>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+static_assert( std::is_same_v<units::Spectrum<units::UAccel>::power_type, units::Unit<0, 2, -4>> );
+static_assert( std::is_same_v<units::Spectrum<units::UAccel>::density_type, units::Unit<0, 2, -3>> );
+static_assert( std::is_same_v<decltype( units::Spectrum<units::UPos>( 4, 1.0_s ).frequency( 1 ) ), units::UHerz> );
+
+std::vector<units::UAccel> test_signal( std::size_t n )
+{
+	std::vector<units::UAccel> res( n );
+	for( std::size_t i = 0; i < n; ++i ) {
+		res[i] = units::UAccel{std::sin( 0.7 * static_cast<double>( i ) ) + 0.1 * static_cast<double>( i % 5 ) - 0.3};
+	}
+	return res;
+}
+
+void check_against_naive_dft()
+{
+	for( std::size_t n : {0u, 1u, 2u, 3u, 8u, 12u, 15u, 64u, 100u, 127u} ) {
+		const auto signal   = test_signal( n );
+		const auto spectrum = units::rfft( signal, 0.01_s );
+		check( spectrum.size() == ( n == 0 ? 0 : n / 2 + 1 ), "number of bins" );
+
+		for( std::size_t k = 0; k < spectrum.size(); ++k ) {
+			std::complex<double> expected{};
+			for( std::size_t i = 0; i < n; ++i ) {
+				const double a = -2.0 * units::pi.value * static_cast<double>( k * i ) / static_cast<double>( n );
+				expected += signal[i].value * std::complex<double>( std::cos( a ), std::sin( a ) );
+			}
+			check( close( spectrum.bin( k ).real(), expected.real() ) && close( spectrum.bin( k ).imag(), expected.imag() ),
+				   "bin matches naive DFT" );
+		}
+	}
+}
+
+void check_typed_results()
+{
+	// 1.5 m/s^2 sinusoid at 25Hz, sampled at 1kHz for 0.2s => exactly on bin 5
+	const std::size_t          n  = 200;
+	const units::UTime         dt = 0.001_s;
+	std::vector<units::UAccel> signal( n );
+	for( std::size_t i = 0; i < n; ++i ) {
+		const auto t = static_cast<double>( i ) * dt;
+		signal[i]    = 0.5_mps2 + 1.5_mps2 * cos( units::UAngle{2.0 * units::pi.value * ( 25.0_hz * t ).value} );
+	}
+
+	const auto spectrum = units::rfft( signal, dt );
+	check( spectrum.resolution() == 5.0_hz, "resolution" );
+	check( close( spectrum.frequency( 5 ).value, 25.0 ), "frequency axis" );
+	check( close( spectrum.amplitude( 0 ).value, 0.5 ), "DC amplitude" );
+	check( close( spectrum.amplitude( 5 ).value, 1.5 ), "sinusoid amplitude" );
+	check( spectrum.amplitude( 7 ).value < 1e-9, "leakage" );
+
+	// Parseval: power summed over all bins equals mean square
+	units::Spectrum<units::UAccel>::power_type total{};
+	units::Spectrum<units::UAccel>::power_type mean_square{};
+	for( std::size_t k = 0; k < spectrum.size(); ++k ) {
+		total += spectrum.power( k );
+	}
+	for( auto v : signal ) {
+		mean_square += square( v ) / static_cast<double>( n );
+	}
+	check( close( total.value, mean_square.value ), "Parseval" );
+	check( close( ( spectrum.psd( 5 ) * spectrum.resolution() ).value, spectrum.power( 5 ).value ), "psd" );
+}
+
+void check_batch()
+{
+	const std::size_t n        = 48;
+	const std::size_t channels = 3;
+
+	std::vector<std::vector<units::UAccel>> single;
+	std::vector<units::UAccel>              interleaved( n * channels );
+	for( std::size_t c = 0; c < channels; ++c ) {
+		single.push_back( test_signal( n + c ) );
+		single.back().resize( n );
+		for( std::size_t i = 0; i < n; ++i ) {
+			interleaved[i * channels + c] = single.back()[i];
+		}
+	}
+
+	const units::FftBatchPlan plan( n, channels );
+	const auto                batch = plan.execute( interleaved.data(), 0.1_s, 1, channels );
+	check( batch.size() == channels, "batch size" );
+	for( std::size_t c = 0; c < channels; ++c ) {
+		const auto expected = units::rfft( single[c], 0.1_s );
+		for( std::size_t k = 0; k < expected.size(); ++k ) {
+			check( batch[c].bin( k ) == expected.bin( k ), "batch matches single" );
+		}
+	}
+
+	check( units::fft_plan( n ) == units::fft_plan( n ), "plan cache" );
+
+	// empty input: no bins, nothing written
+	const auto empty = units::fft_plan( 0 );
+	empty->execute( nullptr, 1, nullptr, nullptr );
+	check( empty->size() == 0 && empty->bins() == 0, "empty plan" );
+}
+
+} // namespace
+
+int main()
+{
+	check_against_naive_dft();
+	check_typed_results();
+	check_batch();
+	return failures == 0 ? 0 : 1;
+}
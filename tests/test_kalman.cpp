@@ -0,0 +1,170 @@
+#include <mba-units/kalman.hpp>
+
+#include "test_common.hpp"
+
+#include <type_traits>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+using State       = units::UList<units::UPos, units::USpeed>;
+using Measurement = units::UList<units::UPos>;
+using Filter      = units::KalmanFilter<State, Measurement>;
+
+// element types follow from the state units
+static_assert( std::is_same_v<Filter::transition_type::element_type<0, 1>, units::UTime> );
+static_assert( std::is_same_v<Filter::transition_type::element_type<1, 0>, units::UHerz> );
+static_assert( std::is_same_v<Filter::transition_type::element_type<0, 0>, units::UNone> );
+static_assert( std::is_same_v<Filter::covariance_type::element_type<0, 1>, units::Unit<0, 2, -1>> );
+static_assert( std::is_same_v<Filter::gain_type::element_type<1, 0>, units::UHerz> );
+static_assert( std::is_same_v<Filter::state_type::element_type<1, 0>, units::USpeed> );
+static_assert( std::is_same_v<decltype( Filter::transition_type{} * Filter::state_type{} ), Filter::state_type> );
+static_assert( std::is_same_v<decltype( Filter::observation_type{} * Filter::covariance_type{} ),
+							  units::UMatrix<Measurement, State>> );
+
+constexpr auto check_matrix_ops()
+{
+	Filter::transition_type f = Filter::transition_type::identity();
+	f.set<0, 1>( 0.5_s );
+
+	Filter::state_type x;
+	x.set<0, 0>( 1.0_m );
+	x.set<1, 0>( 2.0_mps );
+
+	const auto next = f * x;
+	static_assert( Filter::transition_type::identity().get<1, 1>() == units::UNone{1.0} );
+	return next.get<0, 0>() == 2.0_m && next.get<1, 0>() == 2.0_mps && f.transposed().get<1, 0>() == 0.5_s;
+}
+static_assert( check_matrix_ops() );
+
+struct Model {
+	Filter::transition_type        f = Filter::transition_type::identity();
+	Filter::covariance_type        q;
+	Filter::observation_type       h;
+	Filter::measurement_noise_type r;
+
+	explicit Model( units::UTime dt )
+	{
+		f.set<0, 1>( dt );
+		q.set<0, 0>( units::Unit<0, 2, 0>{1e-4} );
+		q.set<1, 1>( units::Unit<0, 2, -2>{1e-3} );
+		h.set<0, 0>( 1.0 );
+		r.set<0, 0>( units::Unit<0, 2, 0>{0.25} );
+	}
+};
+
+Filter::covariance_type initial_covariance()
+{
+	Filter::covariance_type p;
+	p.set<0, 0>( units::Unit<0, 2, 0>{10.0} );
+	p.set<1, 1>( units::Unit<0, 2, -2>{10.0} );
+	return p;
+}
+
+Filter::measurement_type measurement( units::UPos pos )
+{
+	Filter::measurement_type z;
+	z.set<0, 0>( pos );
+	return z;
+}
+
+void check_single_filter_converges()
+{
+	const Model model( 0.1_s );
+	Filter      filter( Filter::state_type{}, initial_covariance() );
+
+	// object moving with 3m/s, measured with a deterministic +-0.5m error pattern
+	for( int i = 1; i <= 200; ++i ) {
+		const auto t = static_cast<double>( i ) * 0.1_s;
+		filter.predict( model.f, model.q );
+		check( filter.update( measurement( 3.0_mps * t + units::UPos{( i % 2 ) ? 0.5 : -0.5} ), model.h, model.r ),
+			   "update" );
+	}
+
+	check( abs( filter.state().get<1, 0>() - 3.0_mps ) < 0.1_mps, "speed estimate" );
+	check( abs( filter.state().get<0, 0>() - 60.0_m ) < 0.5_m, "position estimate" );
+	check( filter.covariance().get<0, 0>() < units::Unit<0, 2, 0>{0.25}, "covariance shrinks" );
+	check( filter.covariance().get<0, 1>() == filter.covariance().get<1, 0>(), "covariance stays symmetric" );
+}
+
+void check_batch_matches_single()
+{
+	const std::size_t count = 37;
+	const Model       model( 0.05_s );
+
+	units::KalmanBatch<State, Measurement> batch( count );
+	std::vector<Filter>                    singles;
+	for( std::size_t f = 0; f < count; ++f ) {
+		Filter::state_type x0;
+		x0.set<0, 0>( units::UPos{1.0 * f} );
+		singles.emplace_back( x0, initial_covariance() );
+		batch.set( f, x0, initial_covariance() );
+	}
+
+	std::vector<Filter::measurement_type> z( count );
+	for( int step = 0; step < 50; ++step ) {
+		batch.predict( model.f, model.q );
+		for( std::size_t f = 0; f < count; ++f ) {
+			singles[f].predict( model.f, model.q );
+			z[f] = measurement( units::UPos{1.0 * f + 0.1 * step * static_cast<double>( f % 5 )} );
+			singles[f].update( z[f], model.h, model.r );
+		}
+		batch.update( z.data(), model.h, model.r );
+	}
+
+	bool same = true;
+	for( std::size_t f = 0; f < count; ++f ) {
+		const auto x = batch.state( f );
+		const auto p = batch.covariance( f );
+		for( std::size_t e = 0; e < 2; ++e ) {
+			same = same && close( x.data()[e], singles[f].state().data()[e] );
+		}
+		for( std::size_t e = 0; e < 4; ++e ) {
+			same = same && close( p.data()[e], singles[f].covariance().data()[e] );
+		}
+	}
+	check( same, "batch matches single filters" );
+}
+
+void check_multi_dimensional_measurement()
+{
+	// position and speed both measured: 2x2 innovation covariance
+	using Full = units::KalmanFilter<State, State>;
+
+	Full::observation_type h = Full::observation_type::identity();
+	Full::covariance_type  r;
+	r.set<0, 0>( units::Unit<0, 2, 0>{1.0} );
+	r.set<1, 1>( units::Unit<0, 2, -2>{1.0} );
+
+	Full::measurement_type z;
+	z.set<0, 0>( 4.0_m );
+	z.set<1, 0>( 2.0_mps );
+
+	Full single( Full::state_type{}, initial_covariance() );
+	single.update( z, h, r );
+
+	units::KalmanBatch<State, State> batch( 3 );
+	for( std::size_t f = 0; f < 3; ++f ) {
+		batch.set( f, Full::state_type{}, initial_covariance() );
+	}
+	const Full::measurement_type zs[] = {z, z, z};
+	batch.update( zs, h, r );
+
+	// 10 / (10 + 1) of the measurement is taken over
+	check( close( single.state().get<0, 0>().value, 40.0 / 11.0 ), "2d update" );
+	check( close( batch.state( 2 ).get<1, 0>().value, 20.0 / 11.0 ), "2d batch update" );
+}
+
+} // namespace
+
+int main()
+{
+	check_single_filter_converges();
+	check_batch_matches_single();
+	check_multi_dimensional_measurement();
+	return failures == 0 ? 0 : 1;
+}
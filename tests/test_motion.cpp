@@ -0,0 +1,104 @@
+#include <mba-units/motion.hpp>
+
+#include "test_common.hpp"
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+static_assert( std::is_same_v<units::UDivide_t<units::UJerk, units::UAccel>, units::UHerz> );
+static_assert( units::MotionPhases{0.5_s, 2.0_s, 1.0_s}.total() == 5.0_s );
+
+// samples the whole profile and checks limits, continuity and the end state
+void check_profile( const units::MotionProfile& p, units::UPos dist, units::USpeed v, units::UAccel a, const char* what )
+{
+	const std::size_t         n = 2001;
+	std::vector<units::UTime> t( n );
+	for( std::size_t i = 0; i < n; ++i ) {
+		t[i] = p.duration() * ( static_cast<double>( i ) / ( n - 1 ) );
+	}
+	std::vector<units::UPos>   pos;
+	std::vector<units::USpeed> speed;
+	std::vector<units::UAccel> accel;
+	p.evaluate( t, pos, speed, accel );
+
+	bool ok = close( pos.front().value, 0.0 ) && close( speed.front().value, 0.0 );
+	ok      = ok && close( pos.back().value, dist.value ) && close( speed.back().value, 0.0, 1e-7 );
+	for( std::size_t i = 0; i < n; ++i ) {
+		ok = ok && abs( speed[i] ) <= v * ( 1.0 + 1e-9 ) && abs( accel[i] ) <= a * ( 1.0 + 1e-9 );
+		if( i > 0 ) {
+			// position must be consistent with the sampled speeds (trapezoidal integration)
+			const auto dp = ( speed[i] + speed[i - 1] ) * ( t[i] - t[i - 1] ) / 2.0;
+			ok            = ok && close( ( pos[i] - pos[i - 1] ).value, dp.value, 1e-4 );
+		}
+
+		const auto single = p.at( t[i] );
+		ok = ok && single.pos == pos[i] && single.speed == speed[i] && single.accel == accel[i];
+	}
+	check( ok, what );
+
+	check( p.at( -1.0_s ).pos == 0.0_m, "before start" );
+	check( close( p.at( p.duration() + 1.0_s ).pos.value, dist.value ) && p.at( p.duration() + 1.0_s ).speed == 0.0_mps,
+		   "after end" );
+}
+
+void check_trapezoidal()
+{
+	// reaches max speed: 1s acceleration (1m), 1m at 2m/s, 1s deceleration
+	const auto p = units::MotionProfile::trapezoidal( 3.0_m, 2.0_mps, 2.0_mps2 );
+	check( close( p.phases().accel.value, 1.0 ) && close( p.phases().cruise.value, 0.5 ), "trapezoidal phases" );
+	check( p.phases().jerk == 0.0_s, "trapezoidal has no jerk phase" );
+	check( close( p.duration().value, 2.5 ), "trapezoidal duration" );
+	check_profile( p, 3.0_m, 2.0_mps, 2.0_mps2, "trapezoidal samples" );
+
+	// triangular
+	const auto tri = units::MotionProfile::trapezoidal( 1.0_m, 2.0_mps, 2.0_mps2 );
+	check( tri.phases().cruise == 0.0_s && close( tri.peak_speed().value, std::sqrt( 2.0 ) ), "triangular" );
+	check_profile( tri, 1.0_m, 2.0_mps, 2.0_mps2, "triangular samples" );
+
+	check_profile( units::MotionProfile::trapezoidal( -3.0_m, 2.0_mps, 2.0_mps2 ), -3.0_m, 2.0_mps, 2.0_mps2, "negative" );
+}
+
+void check_s_curve()
+{
+	const units::UJerk j{10.0};
+
+	// all limits reached
+	const auto p = units::MotionProfile::s_curve( 10.0_m, 2.0_mps, 2.0_mps2, j );
+	check( close( p.phases().jerk.value, 0.2 ) && close( p.phases().accel.value, 1.2 ), "s-curve phases" );
+	check( close( p.peak_speed().value, 2.0 ) && close( p.peak_accel().value, 2.0 ), "s-curve peaks" );
+	check_profile( p, 10.0_m, 2.0_mps, 2.0_mps2, "s-curve samples" );
+
+	// max speed not reached
+	const auto short_move = units::MotionProfile::s_curve( 1.0_m, 2.0_mps, 2.0_mps2, j );
+	check( short_move.phases().cruise == 0.0_s && short_move.peak_speed() < 2.0_mps, "s-curve without cruise" );
+	check_profile( short_move, 1.0_m, 2.0_mps, 2.0_mps2, "s-curve without cruise samples" );
+
+	// max acceleration not reached
+	const auto tiny = units::MotionProfile::s_curve( 0.01_m, 2.0_mps, 2.0_mps2, j );
+	check( tiny.peak_accel() < 2.0_mps2 && tiny.phases().accel == 2.0 * tiny.phases().jerk, "s-curve triangular accel" );
+	check_profile( tiny, 0.01_m, 2.0_mps, 2.0_mps2, "s-curve triangular accel samples" );
+
+	// max speed is reached before max acceleration
+	const auto slow = units::MotionProfile::s_curve( 5.0_m, 0.1_mps, 2.0_mps2, j );
+	check( slow.peak_accel() < 2.0_mps2 && close( slow.peak_speed().value, 0.1 ), "s-curve low speed limit" );
+	check_profile( slow, 5.0_m, 0.1_mps, 2.0_mps2, "s-curve low speed limit samples" );
+
+	check_profile( units::MotionProfile::s_curve( -4.0_m, 2.0_mps, 2.0_mps2, j ), -4.0_m, 2.0_mps, 2.0_mps2, "negative" );
+	check( units::MotionProfile::s_curve( 0.0_m, 2.0_mps, 2.0_mps2, j ).duration() == 0.0_s, "zero distance" );
+}
+
+} // namespace
+
+int main()
+{
+	check_trapezoidal();
+	check_s_curve();
+	return failures == 0 ? 0 : 1;
+}
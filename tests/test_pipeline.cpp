@@ -0,0 +1,156 @@
+#include <mba-units/pipeline.hpp>
+
+#include "test_common.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+// not a multiple of the batch size, so partial batches are exercised
+constexpr std::size_t n = 3 * units::pipeline::batch_size + 17;
+
+std::vector<units::UPos> ramp()
+{
+	std::vector<units::UPos> data( n );
+	for( std::size_t i = 0; i < n; ++i ) {
+		data[i] = units::UPos{static_cast<double>( i )};
+	}
+	return data;
+}
+
+void check_dimensions()
+{
+	const auto data = ramp();
+
+	auto chain = units::pipeline::stream( data )
+				 | units::pipeline::map( []( units::UPos p ) { return p * p; } )
+				 | units::pipeline::differentiate( 1.0_s );
+	static_assert( std::is_same_v<decltype( chain )::value_type, units::Unit<0, 2, -1>> );
+
+	const auto r = units::pipeline::collect( chain );
+	check( r.size() == n - 1, "differentiate drops the first sample" );
+	check( r.back().value == 2.0 * ( n - 1 ) - 1.0, "differentiate value" );
+}
+
+void check_stages()
+{
+	const auto data = ramp();
+
+	const auto even = units::pipeline::stream( data )
+					  | units::pipeline::filter( []( units::UPos p ) { return std::fmod( p.value, 2.0 ) == 0.0; } )
+					  | units::pipeline::collect();
+	bool ok = even.size() == ( n + 1 ) / 2;
+	for( std::size_t i = 0; ok && i < even.size(); ++i ) {
+		ok = even[i].value == 2.0 * i;
+	}
+	check( ok, "filter" );
+
+	const auto none = units::pipeline::stream( data )
+					  | units::pipeline::filter( []( units::UPos ) { return false; } )
+					  | units::pipeline::collect();
+	check( none.empty(), "filter rejecting everything" );
+
+	const auto mean = units::pipeline::stream( data ) | units::pipeline::moving_mean( 5 ) | units::pipeline::collect();
+	ok = mean.size() == n - 4;
+	for( std::size_t i = 0; ok && i < mean.size(); ++i ) {
+		ok = close( mean[i].value, static_cast<double>( i ) + 2.0 );
+	}
+	check( ok, "moving_mean" );
+
+	// 10 s -> 4 s: outputs at multiples of 0.4 input samples
+	const auto up = units::pipeline::stream( data ) | units::pipeline::resample( 10.0_s, 4.0_s ) | units::pipeline::collect();
+	ok = up.size() == static_cast<std::size_t>( ( n - 1 ) / 0.4 ) + 1;
+	for( std::size_t i = 0; ok && i < up.size(); ++i ) {
+		ok = close( up[i].value, 0.4 * static_cast<double>( i ), 1e-9 );
+	}
+	check( ok, "resample up" );
+
+	const auto down = units::pipeline::stream( data ) | units::pipeline::resample( 1.0_s, 3.0_s ) | units::pipeline::collect();
+	ok = down.size() == ( n - 1 ) / 3 + 1;
+	for( std::size_t i = 0; ok && i < down.size(); ++i ) {
+		ok = close( down[i].value, 3.0 * static_cast<double>( i ) );
+	}
+	check( ok, "resample down" );
+
+	const std::vector<units::UPos> single{2.5_m};
+	const auto one = units::pipeline::stream( single ) | units::pipeline::resample( 1.0_s, 3.0_s ) | units::pipeline::collect();
+	check( one.size() == 1 && one[0] == 2.5_m, "resample a single sample" );
+
+	const std::vector<units::UPos> empty;
+	check( ( units::pipeline::stream( empty ) | units::pipeline::resample( 1.0_s, 3.0_s ) | units::pipeline::collect() ).empty(),
+		   "resample an empty stream" );
+
+	const auto rejects = [&]( units::UTime in_dt, units::UTime out_dt ) {
+		try {
+			units::pipeline::stream( data ) | units::pipeline::resample( in_dt, out_dt );
+		} catch( const std::invalid_argument& ) {
+			return true;
+		}
+		return false;
+	};
+	check( rejects( 1.0_s, 0.0_s ) && rejects( 1.0_s, -1.0_s ) && rejects( 0.0_s, 1.0_s )
+			   && rejects( 1.0_s, units::UTime{std::numeric_limits<double>::quiet_NaN()} ),
+		   "resample rejects invalid steps" );
+}
+
+void check_threaded()
+{
+	const auto data = ramp();
+
+	const auto make = [&]( bool threaded ) {
+		auto front = units::pipeline::stream( data ) | units::pipeline::map( []( units::UPos p ) { return p / 2.0_s; } );
+		if( threaded ) {
+			return units::pipeline::collect( std::move( front ) | units::pipeline::threaded( 2 )
+											 | units::pipeline::moving_mean( 3 ) );
+		}
+		return units::pipeline::collect( std::move( front ) | units::pipeline::moving_mean( 3 ) );
+	};
+	const auto direct   = make( false );
+	const auto parallel = make( true );
+	check( direct == parallel && direct.size() == n - 2, "threaded pipeline" );
+
+	// abandoning a threaded pipeline early must not block
+	{
+		auto p = units::pipeline::stream( data ) | units::pipeline::threaded( 1 );
+		units::UPos first[4];
+		check( p.pull( first, 4 ) == 4 && first[3].value == 3.0, "threaded partial pull" );
+	}
+
+	bool thrown = false;
+	try {
+		const auto throwing = []( units::UPos p ) {
+			if( p.value > 2000.0 ) {
+				throw std::runtime_error( "boom" );
+			}
+			return p;
+		};
+		units::pipeline::stream( data ) | units::pipeline::map( throwing ) | units::pipeline::threaded()
+			| units::pipeline::collect();
+	} catch( const std::runtime_error& ) {
+		thrown = true;
+	}
+	check( thrown, "threaded exception propagation" );
+
+	std::size_t count = 0;
+	units::pipeline::for_each_batch( units::pipeline::stream( data ) | units::pipeline::threaded(),
+									 [&]( const units::UPos*, std::size_t c ) { count += c; } );
+	check( count == n, "for_each_batch" );
+}
+
+} // namespace
+
+int main()
+{
+	check_dimensions();
+	check_stages();
+	check_threaded();
+	return failures == 0 ? 0 : 1;
+}
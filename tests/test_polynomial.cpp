@@ -0,0 +1,100 @@
+#include <mba-units/polynomial.hpp>
+
+#include "test_common.hpp"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+using Trajectory = units::Polynomial<units::UPos, units::UTime, 2>;
+
+// coefficient types follow from Y and X
+static_assert( std::is_same_v<Trajectory::coefficient_type<0>, units::UPos> );
+static_assert( std::is_same_v<Trajectory::coefficient_type<1>, units::USpeed> );
+static_assert( std::is_same_v<Trajectory::coefficient_type<2>, units::UAccel> );
+static_assert( units::coefficients_match_v<units::UPos, units::UTime, units::UPos, units::USpeed, units::UAccel> );
+static_assert( !units::coefficients_match_v<units::UPos, units::UTime, units::UPos, units::UAccel, units::USpeed> );
+static_assert( !std::is_constructible_v<Trajectory, units::UPos, units::USpeed> );
+
+// derivatives and integrals are dimensioned accordingly
+static_assert( std::is_same_v<Trajectory::derivative_type, units::Polynomial<units::USpeed, units::UTime, 1>> );
+static_assert( std::is_same_v<Trajectory::derivative_type::derivative_type,
+							  units::Polynomial<units::UAccel, units::UTime, 0>> );
+static_assert( std::is_same_v<Trajectory::integral_type,
+							  units::Polynomial<units::Unit<0, 1, 1>, units::UTime, 3>> );
+
+constexpr Trajectory fall{10.0_m, 2.0_mps, units::UAccel{-9.81 / 2.0}};
+
+static_assert( fall( 0.0_s ) == 10.0_m );
+static_assert( fall( 2.0_s ) == units::UPos{10.0 + 4.0 - 9.81 * 2.0} );
+static_assert( fall.derivative()( 1.0_s ) == units::USpeed{2.0 - 9.81} );
+static_assert( fall.derivative().derivative()( 123.0_s ) == units::UAccel{-9.81} );
+static_assert( fall.derivative().derivative().derivative() == units::Polynomial<units::Unit<0, 1, -3>, units::UTime, 0>{} );
+static_assert( fall.integral().derivative() == fall );
+static_assert( std::is_same_v<decltype( units::make_polynomial<units::UTime>( 1.0_m, 2.0_mps ) ),
+							  units::Polynomial<units::UPos, units::UTime, 1>> );
+
+constexpr bool check_accessors()
+{
+	Trajectory p;
+	p.set<1>( 3.0_mps );
+	return p.get<1>() == 3.0_mps && p.get<0>() == 0.0_m && ( p + p ).get<1>() == 6.0_mps && ( p - p ) == Trajectory{};
+}
+static_assert( check_accessors() );
+
+template<std::size_t D, std::size_t... I>
+bool estrin_matches_horner( std::index_sequence<I...> )
+{
+	units::Polynomial<units::UNone, units::UNone, D> p;
+	( p.template set<I>( units::UNone{1.0 / static_cast<double>( I + 1 ) - 0.3} ), ... );
+
+	for( double x = -2.0; x <= 2.0; x += 0.125 ) {
+		if( !close( p.horner( units::UNone{x} ).value, p.estrin( units::UNone{x} ).value, 1e-12 ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template<std::size_t D>
+bool estrin_matches_horner()
+{
+	return estrin_matches_horner<D>( std::make_index_sequence<D + 1>{} );
+}
+
+void check_evaluation()
+{
+	check( estrin_matches_horner<0>() && estrin_matches_horner<1>() && estrin_matches_horner<2>()
+			   && estrin_matches_horner<3>() && estrin_matches_horner<6>() && estrin_matches_horner<9>(),
+		   "estrin == horner" );
+
+	std::vector<units::UTime> t( 1001 );
+	for( std::size_t i = 0; i < t.size(); ++i ) {
+		t[i] = units::UTime{0.001 * static_cast<double>( i )};
+	}
+	const auto pos = fall.evaluate( t );
+	bool       ok  = pos.size() == t.size();
+	for( std::size_t i = 0; ok && i < t.size(); ++i ) {
+		const double ts = t[i].value;
+		ok              = close( pos[i].value, 10.0 + 2.0 * ts - 9.81 / 2.0 * ts * ts, 1e-12 );
+	}
+	check( ok, "batch evaluation" );
+
+	// integral with a constant: area under the position curve from 0 to 2 s
+	const auto area = fall.integral( units::Unit<0, 1, 1>{5.0} );
+	check( close( ( area( 2.0_s ) - area( 0.0_s ) ).value, 20.0 + 4.0 - 9.81 / 6.0 * 8.0, 1e-12 ), "integral" );
+}
+
+} // namespace
+
+int main()
+{
+	check_evaluation();
+	return failures == 0 ? 0 : 1;
+}
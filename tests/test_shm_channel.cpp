@@ -0,0 +1,134 @@
+#include <mba-units/shm_channel.hpp>
+
+#include "test_common.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+using Record = units::UnitRecord<units::UPos, units::UAngle, units::UTime>;
+
+static_assert( sizeof( Record ) == 3 * sizeof( double ) );
+static_assert( Record{{1.0, 2.0, 3.0}}.get<1>() == 2.0_rad );
+static_assert( std::is_same_v<decltype( Record{}.get<2>() ), units::UTime> );
+
+std::string channel_name( const char* suffix )
+{
+	return "/mba_units_test_" + std::to_string( ::getpid() ) + "_" + suffix;
+}
+
+void check_roundtrip()
+{
+	units::ShmWriter<units::UPos, units::UAngle, units::UTime> writer( channel_name( "rt" ), 3 );
+	check( writer.capacity() == 4, "capacity rounded to power of two" );
+
+	units::ShmReader<units::UPos, units::UAngle, units::UTime> reader( writer.name() );
+	check( reader.peek() == nullptr, "empty" );
+
+	for( int i = 0; i < 4; ++i ) {
+		check( writer.try_write( units::UPos{1.0 * i}, units::UAngle{2.0 * i}, units::UTime{3.0 * i} ), "write" );
+	}
+	check( !writer.try_write( 0.0_m, 0.0_rad, 0.0_s ), "full" );
+
+	for( int i = 0; i < 4; ++i ) {
+		const auto* rec = reader.peek();
+		check( rec != nullptr && rec->get<0>() == units::UPos{1.0 * i} && rec->get<1>() == units::UAngle{2.0 * i}
+				   && rec->get<2>() == units::UTime{3.0 * i},
+			   "read" );
+		reader.pop();
+	}
+	check( reader.peek() == nullptr, "drained" );
+
+	// in place write
+	auto* slot = writer.try_claim();
+	slot->set<0>( 5.0_m );
+	slot->set<1>( 0.5_rad );
+	slot->set<2>( 7.0_s );
+	writer.publish();
+	check( reader.peek() && reader.peek()->get<0>() == 5.0_m, "claim/publish" );
+}
+
+void check_schema_mismatch()
+{
+	units::ShmWriter<units::UPos, units::UAngle> writer( channel_name( "schema" ), 4 );
+
+	auto attach_fails = []( auto reader_tag, const std::string& name ) {
+		using Reader = typename decltype( reader_tag )::type;
+		try {
+			Reader r( name );
+		} catch( const std::runtime_error& ) {
+			return true;
+		}
+		return false;
+	};
+	struct SwappedTypes {
+		using type = units::ShmReader<units::UAngle, units::UPos>;
+	};
+	struct WrongExponent {
+		using type = units::ShmReader<units::UPos, units::UNone>;
+	};
+	struct WrongCount {
+		using type = units::ShmReader<units::UPos>;
+	};
+	check( attach_fails( SwappedTypes{}, writer.name() ), "swapped fields rejected" );
+	check( attach_fails( WrongExponent{}, writer.name() ), "angle vs dimensionless rejected" );
+	check( attach_fails( WrongCount{}, writer.name() ), "field count rejected" );
+
+	bool missing = false;
+	try {
+		units::ShmReader<units::UPos> r( channel_name( "does_not_exist" ) );
+	} catch( const std::system_error& ) {
+		missing = true;
+	}
+	check( missing, "missing channel" );
+}
+
+void check_wait( units::WaitMode mode )
+{
+	units::ShmWriter<units::UTime> writer( channel_name( mode == units::WaitMode::futex ? "futex" : "poll" ), 16, mode );
+	units::ShmReader<units::UTime> reader( writer.name() );
+	check( reader.wait_mode() == mode, "wait mode recorded" );
+	check( reader.wait( std::chrono::milliseconds( 1 ) ) == nullptr, "wait times out" );
+
+	std::thread producer( [&] {
+		for( int i = 0; i < 100; ++i ) {
+			while( !writer.try_write( units::UTime{1.0 * i} ) ) {
+				std::this_thread::yield();
+			}
+			if( i % 10 == 0 ) {
+				std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+			}
+		}
+	} );
+
+	bool in_order = true;
+	for( int i = 0; i < 100; ++i ) {
+		const auto* rec = reader.wait( std::chrono::seconds( 5 ) );
+		in_order        = in_order && rec != nullptr && rec->get<0>() == units::UTime{1.0 * i};
+		if( rec ) {
+			reader.pop();
+		}
+	}
+	producer.join();
+	check( in_order, "records arrive in order" );
+}
+
+} // namespace
+
+int main()
+{
+	check_roundtrip();
+	check_schema_mismatch();
+	check_wait( units::WaitMode::polling );
+	check_wait( units::WaitMode::futex );
+	return failures == 0 ? 0 : 1;
+}
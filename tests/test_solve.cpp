@@ -0,0 +1,134 @@
+#include <mba-units/solve.hpp>
+
+#include "test_common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+// time until a body starting at p0 with v0 and constant a reaches 0
+struct Fall {
+	units::UPos          p0;
+	units::USpeed        v0;
+	units::UAccel a;
+
+	units::UPos   position( units::UTime t ) const { return p0 + v0 * t + a * t * t / 2.0; }
+	units::USpeed speed( units::UTime t ) const { return v0 + a * t; }
+};
+
+void check_scalar()
+{
+	const Fall  fall{10.0_m, 0.0_mps, units::UAccel{-9.81}};
+	const auto  expected = std::sqrt( 2.0 * 10.0 / 9.81 );
+	const auto  f        = [&]( units::UTime t ) { return fall.position( t ); };
+	const auto  df       = [&]( units::UTime t ) { return fall.speed( t ); };
+
+	const auto n = units::newton( f, df, 1.0_s, 1e-12_s );
+	static_assert( std::is_same_v<decltype( n ), const units::RootResult<units::UTime>> );
+	check( n.converged && close( n.root.value, expected ), "newton" );
+
+	const auto b = units::bisect( f, 0.0_s, 10.0_s, 1e-12_s );
+	check( b.converged && close( b.root.value, expected, 1e-11 ), "bisect" );
+
+	const auto r = units::brent( f, 0.0_s, 10.0_s, 1e-12_s );
+	check( r.converged && close( r.root.value, expected, 1e-11 ), "brent" );
+	check( r.iterations < b.iterations, "brent faster than bisection" );
+
+	const auto no_bracket = units::brent( f, 2.0_s, 3.0_s, 1e-12_s );
+	check( !no_bracket.converged, "brent without sign change" );
+	check( !units::bisect( f, 2.0_s, 3.0_s, 1e-12_s ).converged, "bisect without sign change" );
+
+	const auto flat = units::newton( f, []( units::UTime ) { return units::USpeed{0.0}; }, 1.0_s, 1e-12_s );
+	check( !flat.converged, "newton with zero derivative" );
+
+	// dimensionless function
+	const auto c = units::brent( []( units::UNone x ) { return x * x - units::UNone{2.0}; },
+								 units::UNone{0.0},
+								 units::UNone{2.0},
+								 units::UNone{1e-12} );
+	check( c.converged && close( c.root.value, std::sqrt( 2.0 ) ), "brent unitless" );
+}
+
+void check_minimize()
+{
+	// highest point of a vertical throw
+	const Fall throw_up{0.0_m, 20.0_mps, units::UAccel{-9.81}};
+
+	const auto m = units::minimize_golden( [&]( units::UTime t ) { return -throw_up.position( t ); },
+										   0.0_s,
+										   5.0_s,
+										   1e-9_s );
+	static_assert( std::is_same_v<decltype( m.value ), units::UPos> );
+	check( m.converged && close( m.argument.value, 20.0 / 9.81, 1e-8 ), "golden section argument" );
+	check( close( -m.value.value, 20.0 * 20.0 / ( 2 * 9.81 ) ), "golden section value" );
+}
+
+void check_batch()
+{
+	constexpr std::size_t n = 37;
+
+	std::vector<Fall>        bodies;
+	std::vector<units::UTime> expected;
+	for( std::size_t i = 0; i < n; ++i ) {
+		const double p0 = 1.0 + static_cast<double>( i );
+		const double v0 = static_cast<double>( i % 5 ) - 2.0;
+		const double a  = -1.0 - static_cast<double>( i % 3 );
+		bodies.push_back( {units::UPos{p0}, units::USpeed{v0}, units::UAccel{a}} );
+		expected.push_back( units::UTime{( -v0 - std::sqrt( v0 * v0 - 2.0 * a * p0 ) ) / a} );
+	}
+	const auto f  = [&]( std::size_t i, units::UTime t ) { return bodies[i].position( t ); };
+	const auto df = [&]( std::size_t i, units::UTime t ) { return bodies[i].speed( t ); };
+
+	std::vector<units::UTime> roots( n, 10.0_s );
+	bool                      conv[n] = {};
+	check( units::newton_batch( f, df, roots.data(), n, 1e-12_s, 50, conv ) == n, "newton_batch converged" );
+	bool all_close = true;
+	for( std::size_t i = 0; i < n; ++i ) {
+		all_close = all_close && conv[i] && close( roots[i].value, expected[i].value );
+	}
+	check( all_close, "newton_batch roots" );
+
+	// a lane producing NaN must not be reported as converged
+	const auto f_nan = [&]( std::size_t i, units::UTime t ) {
+		return i == 5 ? units::UPos{std::numeric_limits<double>::quiet_NaN()} : bodies[i].position( t );
+	};
+	std::fill( roots.begin(), roots.end(), 10.0_s );
+	check( units::newton_batch( f_nan, df, roots.data(), n, 1e-12_s, 50, conv ) == n - 1, "newton_batch nan lane" );
+	check( !conv[5] && conv[4] && close( roots[4].value, expected[4].value ), "newton_batch nan lane flags" );
+	check( !units::newton( [&]( units::UTime t ) { return f_nan( 5, t ); },
+						   [&]( units::UTime t ) { return df( 5, t ); },
+						   10.0_s,
+						   1e-12_s )
+				.converged,
+		   "newton nan" );
+
+	std::vector<units::UTime> lo( n, 0.0_s );
+	std::vector<units::UTime> hi( n, 100.0_s );
+	// one problem without a sign change
+	hi[3] = units::UTime{1e-6};
+	check( units::bisect_batch( f, lo.data(), hi.data(), roots.data(), n, 1e-10_s, 200, conv ) == n - 1,
+		   "bisect_batch converged" );
+	all_close = !conv[3];
+	for( std::size_t i = 0; i < n; ++i ) {
+		all_close = all_close && ( i == 3 || ( conv[i] && close( roots[i].value, expected[i].value, 1e-9 ) ) );
+	}
+	check( all_close, "bisect_batch roots" );
+}
+
+} // namespace
+
+int main()
+{
+	check_scalar();
+	check_minimize();
+	check_batch();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include <mba-units/spatial.hpp>
+
+#include "test_common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace mba;
+using namespace mba::test;
+using namespace mba::units::litterals;
+
+namespace {
+
+static_assert( std::is_same_v<units::UPosSquared, units::Unit<0, 2, 0>> );
+static_assert( units::distance_squared( units::UPosVec<2>{3.0_m, 0.0_m}, units::UPosVec<2>{0.0_m, 4.0_m} )
+			   == units::UPosSquared{25.0} );
+
+std::vector<units::UPosVec<3>> random_points( std::size_t count, unsigned seed )
+{
+	std::mt19937                           gen( seed );
+	std::uniform_real_distribution<double> dist( -50.0, 50.0 );
+
+	std::vector<units::UPosVec<3>> points( count );
+	for( auto& p : points ) {
+		for( auto& c : p ) {
+			c = units::UPos{dist( gen )};
+		}
+	}
+	return points;
+}
+
+std::vector<std::size_t> brute_force_radius( const std::vector<units::UPosVec<3>>& points,
+											 const units::UPosVec<3>&              q,
+											 units::UPos                           r )
+{
+	std::vector<std::size_t> res;
+	for( std::size_t i = 0; i < points.size(); ++i ) {
+		if( distance_squared( points[i], q ) <= square( r ) ) {
+			res.push_back( i );
+		}
+	}
+	return res;
+}
+
+std::vector<std::size_t> sorted_indices( std::vector<units::SpatialHit> hits )
+{
+	std::vector<std::size_t> res;
+	for( auto h : hits ) {
+		res.push_back( h.index );
+	}
+	std::sort( res.begin(), res.end() );
+	return res;
+}
+
+void check_radius_queries()
+{
+	const auto points  = random_points( 2000, 1 );
+	const auto queries = random_points( 50, 2 );
+
+	units::UniformGrid<3> grid( 5.0_m );
+	grid.build( points );
+	const units::KdTree<3> tree( points );
+
+	for( const auto& q : queries ) {
+		const auto expected = brute_force_radius( points, q, 7.5_m );
+		check( sorted_indices( grid.radius_query( q, 7.5_m ) ) == expected, "grid radius query" );
+		check( sorted_indices( tree.radius_query( q, 7.5_m ) ) == expected, "kd-tree radius query" );
+	}
+}
+
+void check_grid_limits()
+{
+	const auto points = random_points( 500, 8 );
+	const auto q      = points[0];
+	const auto inf    = std::numeric_limits<double>::infinity();
+	const auto nan    = std::numeric_limits<double>::quiet_NaN();
+
+	units::UniformGrid<3> grid( 5.0_m );
+	grid.build( points );
+
+	// the boxes of these radii contain far more cells than the grid has occupied ones
+	check( sorted_indices( grid.radius_query( q, 1.0e6_m ) ) == brute_force_radius( points, q, 1.0e6_m ),
+		   "grid radius query with a huge radius" );
+	check( grid.radius_query( q, units::UPos{inf} ).size() == points.size(), "grid radius query with an infinite radius" );
+	check( grid.radius_query( q, -1.0_m ).empty(), "grid radius query with a negative radius" );
+	check( grid.radius_query( units::UPosVec<3>{units::UPos{nan}, 0.0_m, 0.0_m}, 10.0_m ).empty(),
+		   "grid radius query at NaN" );
+
+	// cells beyond the range of std::int64_t
+	units::UniformGrid<3> far( 1.0_m );
+	far.insert( units::UPosVec<3>{units::UPos{1.0e300}, 0.0_m, 0.0_m} );
+	far.insert( units::UPosVec<3>{units::UPos{-inf}, 0.0_m, 0.0_m} );
+	check( far.radius_query( units::UPosVec<3>{units::UPos{1.0e300}, 0.0_m, 0.0_m}, 1.0_m ).size() == 1,
+		   "grid with huge coordinates" );
+
+	const auto rejects = [&]( units::UPos cell_size ) {
+		try {
+			units::UniformGrid<3> g( cell_size );
+		} catch( const std::invalid_argument& ) {
+			return true;
+		}
+		return false;
+	};
+	check( rejects( 0.0_m ) && rejects( -1.0_m ) && rejects( units::UPos{inf} ) && rejects( units::UPos{nan} ),
+		   "grid rejects invalid cell sizes" );
+}
+
+void check_nearest()
+{
+	const auto points  = random_points( 2000, 3 );
+	const auto queries = random_points( 500, 4 );
+
+	const units::KdTree<3> tree( points );
+
+	std::vector<units::SpatialHit> batch( queries.size() );
+	units::batch_nearest( tree, queries.data(), queries.size(), batch.data(), 4 );
+
+	for( std::size_t qi = 0; qi < queries.size(); ++qi ) {
+		auto best = units::distance_squared( points[0], queries[qi] );
+		for( const auto& p : points ) {
+			best = min( best, units::distance_squared( p, queries[qi] ) );
+		}
+		const auto hit = tree.nearest( queries[qi] );
+		check( hit.has_value() && hit->distance_squared == best, "kd-tree nearest" );
+		check( batch[qi].distance_squared == best, "kd-tree batch nearest" );
+	}
+
+	check( !units::KdTree<3>{}.nearest( queries[0] ).has_value(), "empty kd-tree" );
+
+	units::batch_nearest( units::KdTree<3>{}, queries.data(), queries.size(), batch.data(), 2 );
+	check( batch[0].index == units::no_spatial_hit && std::isinf( batch[0].distance_squared.value )
+			   && batch.back().index == units::no_spatial_hit,
+		   "empty kd-tree batch nearest" );
+}
+
+void check_moving_points()
+{
+	auto points = random_points( 300, 5 );
+
+	units::UniformGrid<3> grid( 4.0_m );
+	for( const auto& p : points ) {
+		grid.insert( p );
+	}
+
+	std::mt19937                           gen( 6 );
+	std::uniform_real_distribution<double> step( -3.0, 3.0 );
+	for( int frame = 0; frame < 10; ++frame ) {
+		for( std::size_t i = 0; i < points.size(); ++i ) {
+			for( auto& c : points[i] ) {
+				c += units::UPos{step( gen )};
+			}
+			grid.move( i, points[i] );
+		}
+	}
+
+	const auto queries = random_points( 100, 7 );
+
+	std::vector<std::vector<units::SpatialHit>> batch;
+	units::batch_radius_query( grid, queries.data(), queries.size(), 10.0_m, batch, 3 );
+	for( std::size_t qi = 0; qi < queries.size(); ++qi ) {
+		check( sorted_indices( batch[qi] ) == brute_force_radius( points, queries[qi], 10.0_m ),
+			   "grid radius query after moves" );
+	}
+}
+
+} // namespace
+
+int main()
+{
+	check_radius_queries();
+	check_grid_limits();
+	check_nearest();
+	check_moving_points();
+	return failures == 0 ? 0 : 1;
+}
@@ -179,6 +179,19 @@ constexpr auto check_litterals()
 	return 1;
 }
 
+constexpr auto check_dimension()
+{
+	using D = units::UDimension<units::UForce>;
+	static_assert( D::kilogram == 1 && D::meter == 1 && D::second == -2 && !D::is_angle );
+	static_assert( units::UDimension<units::UNone>::meter == 0 && !units::UDimension<units::UNone>::is_angle );
+	static_assert( units::UDimension<units::UAngle>::is_angle );
+	static_assert( std::is_same_v<units::UPower_t<units::USpeed, 2>, units::Unit<0, 2, -2>> );
+	static_assert( std::is_same_v<units::UDivide_t<units::UAccel, units::UTime>, units::UJerk> );
+	static_assert( std::is_same_v<units::UPower_t<units::UTime, -1>, units::UHerz> );
+	static_assert( std::is_same_v<units::UPower_t<units::UForce, 0>, units::UNone> );
+	return 1;
+}
+
 /* Helpers */
 constexpr int check_canTakeSqrt()
 {
@@ -233,6 +246,8 @@ constexpr int check_canTakeSqrt()
 
 [[maybe_unused]] constexpr auto pc1 = check_litterals();
 
+[[maybe_unused]] constexpr auto dc1 = check_dimension();
+
 [[maybe_unused]] constexpr auto hc2 = check_canTakeSqrt();
 
 } // namespace